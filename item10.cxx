@@ -4,6 +4,17 @@
 #include <mutex>
 #include <unordered_map>
 #include <list>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 
 // ITEM 10: Prefer scoped enums to unscoped enums.
@@ -192,6 +203,285 @@ namespace item10 {
     {
         return static_cast<std::underlying_type_t<E>>(enumerator);
     }
+
+    // Storing millions of UserInfos as an array of tuples means that a scan
+    // of reputations drags every name and email through the cache with it.
+    // EnumTable stores one column per enumerator of E instead (structure of
+    // arrays), with the columns looked up during compilation the same way
+    // std::get<toUtType(UserInfoFileds::uiEmail)>(uInfo) looks up a field.
+    //
+    // A column is spelled as the type it holds, or as Dictionary<T> to store
+    // each distinct value once and a 32-bit code per row; worthwhile for
+    // strings that repeat a lot.
+    template<typename T>
+    struct Dictionary {};
+
+    template<typename T>
+    class PlainColumn {
+    public:
+        using value_type = T;
+
+        void push_back(const T& value) { values.push_back(value); }
+        void reserve(std::size_t n) { values.reserve(n); }
+        std::size_t size() const noexcept { return values.size(); }
+        const T& operator[](std::size_t row) const noexcept { return values[row]; }
+
+        template<typename F>
+        void scan(F&& f) const { for (const auto& v : values) f(v); }
+
+    private:
+        std::vector<T> values;
+    };
+
+    template<typename T>
+    class DictionaryColumn {
+    public:
+        using value_type = T;
+        using Code = std::uint32_t;
+
+        void push_back(const T& value) {
+            auto pos = index.find(value);
+            if (pos == index.end()) {
+                pos = index.emplace(value, static_cast<Code>(dictionary.size())).first;
+                dictionary.push_back(value);
+            }
+            codes.push_back(pos->second);
+        }
+
+        void reserve(std::size_t n) { codes.reserve(n); }
+        std::size_t size() const noexcept { return codes.size(); }
+        const T& operator[](std::size_t row) const noexcept { return dictionary[codes[row]]; }
+
+        template<typename F>
+        void scan(F&& f) const { for (auto c : codes) f(dictionary[c]); }
+
+        // Comparing codes instead of values: look the value up once, then
+        // scan 4 bytes per row.
+        std::size_t count(const T& value) const {
+            auto pos = index.find(value);
+            if (pos == index.end()) return 0;
+            return static_cast<std::size_t>(std::count(codes.begin(), codes.end(), pos->second));
+        }
+
+        std::size_t distinct() const noexcept { return dictionary.size(); }
+        const std::vector<Code>& rowCodes() const noexcept { return codes; }
+        const T& decode(Code code) const noexcept { return dictionary[code]; }
+
+    private:
+        std::vector<Code> codes;            // one per row
+        std::vector<T> dictionary;          // one per distinct value
+        std::unordered_map<T, Code> index;
+    };
+
+    template<typename Spec>
+    struct ColumnFor { using type = PlainColumn<Spec>; };
+
+    template<typename T>
+    struct ColumnFor<Dictionary<T>> { using type = DictionaryColumn<T>; };
+
+    template<typename Spec>
+    using ColumnFor_t = typename ColumnFor<Spec>::type;
+
+    template<typename E, typename... Specs>
+    class EnumTable {
+    public:
+        using Row = std::tuple<typename ColumnFor_t<Specs>::value_type...>;
+
+        template<E field>
+        const auto& column() const noexcept {
+            static_assert(toUtType(field) < sizeof...(Specs), "EnumTable: no column for this enumerator");
+            return std::get<toUtType(field)>(columns);
+        }
+
+        template<E field>
+        const auto& get(std::size_t row) const noexcept { return column<field>()[row]; }
+
+        // visits one column only; the other columns aren't touched
+        template<E field, typename F>
+        void scan(F&& f) const { column<field>().scan(std::forward<F>(f)); }
+
+        void push_back(const Row& row) { pushBack(row, std::index_sequence_for<Specs...>{}); }
+
+        Row row(std::size_t i) const { return makeRow(i, std::index_sequence_for<Specs...>{}); }
+
+        void reserve(std::size_t n) {
+            std::apply([n](auto&... c) { (c.reserve(n), ...); }, columns);
+        }
+
+        std::size_t size() const noexcept { return std::get<0>(columns).size(); }
+
+    private:
+        template<std::size_t... Is>
+        void pushBack(const Row& row, std::index_sequence<Is...>) {
+            (std::get<Is>(columns).push_back(std::get<Is>(row)), ...);
+        }
+
+        template<std::size_t... Is>
+        Row makeRow(std::size_t i, std::index_sequence<Is...>) const {
+            return Row(std::get<Is>(columns)[i]...);
+        }
+
+        std::tuple<ColumnFor_t<Specs>...> columns;
+    };
+
+    using UserInfoTable = EnumTable<UserInfoFileds, std::string, std::string, std::size_t>;
+
+    // names repeat, emails don't
+    using EncodedUserInfoTable =
+        EnumTable<UserInfoFileds, Dictionary<std::string>, std::string, std::size_t>;
+
+    static_assert(std::is_same<UserInfoTable::Row, UserInfo>::value, "");
+    static_assert(std::is_same<EncodedUserInfoTable::Row, UserInfo>::value, "");
+
+    // Counting Statuses. The enumerators are sparse (0 through 0xFFFFFFFF),
+    // so rather than hash them into an unordered_map at run time, a multiplier
+    // is found during compilation that sends each of them to its own slot of a
+    // small table: statusIndex is then a multiply, a shift, a load and a
+    // compare, with no branches. Values that aren't enumerators (a Status can
+    // hold any std::uint32_t) get index unknownStatusIndex.
+    constexpr std::array<Status, 6> allStatuses = {
+        Status::good, Status::failed, Status::incomplete,
+        Status::corrupt, Status::audited, Status::indeterminate
+    };
+
+    constexpr std::size_t numStatuses = allStatuses.size();
+    constexpr std::size_t unknownStatusIndex = numStatuses;
+
+    namespace status_detail {
+        constexpr unsigned slotBits = 3;            // 8 slots for 6 enumerators
+        constexpr std::size_t numSlots = std::size_t{ 1 } << slotBits;
+
+        constexpr std::size_t slotOf(std::uint32_t value, std::uint32_t multiplier) noexcept {
+            return static_cast<std::uint32_t>(value * multiplier) >> (32 - slotBits);
+        }
+
+        constexpr bool collisionFree(std::uint32_t multiplier) noexcept {
+            bool used[numSlots] = {};
+            for (auto s : allStatuses) {
+                auto slot = slotOf(toUtType(s), multiplier);
+                if (used[slot]) return false;
+                used[slot] = true;
+            }
+            return true;
+        }
+
+        // Candidates jump around pseudo-randomly (odd, from a linear
+        // congruential sequence): neighbouring multipliers map small values
+        // nearly alike, so stepping through them one by one takes forever.
+        constexpr std::uint32_t findMultiplier() noexcept {
+            std::uint32_t m = 0x9E3779B1u;
+            while (!collisionFree(m)) m = (m * 1664525u + 1013904223u) | 1u;
+            return m;
+        }
+
+        constexpr std::uint32_t multiplier = findMultiplier();
+
+        struct Slots {
+            std::uint32_t keys[numSlots];
+            std::uint8_t indices[numSlots];
+        };
+
+        // A free slot holds the key of an enumerator that belongs in some
+        // other slot, so no value arriving at the free slot can match it.
+        constexpr Slots makeSlots() noexcept {
+            Slots t{};
+            for (std::size_t i = 0; i < numSlots; ++i) {
+                t.indices[i] = static_cast<std::uint8_t>(unknownStatusIndex);
+            }
+            for (std::size_t i = 0; i < numSlots; ++i) {
+                for (auto s : allStatuses) {
+                    if (slotOf(toUtType(s), multiplier) != i) { t.keys[i] = toUtType(s); break; }
+                }
+            }
+            for (std::size_t i = 0; i < numStatuses; ++i) {
+                auto slot = slotOf(toUtType(allStatuses[i]), multiplier);
+                t.keys[slot] = toUtType(allStatuses[i]);
+                t.indices[slot] = static_cast<std::uint8_t>(i);
+            }
+            return t;
+        }
+
+        constexpr Slots slots = makeSlots();
+    }
+
+    constexpr std::size_t statusIndex(Status s) noexcept {
+        auto value = toUtType(s);
+        auto slot = status_detail::slotOf(value, status_detail::multiplier);
+        return status_detail::slots.keys[slot] == value ? status_detail::slots.indices[slot]
+                                                        : unknownStatusIndex;
+    }
+
+    constexpr bool denseAndInOrder() noexcept {
+        for (std::size_t i = 0; i < numStatuses; ++i)
+            if (statusIndex(allStatuses[i]) != i) return false;
+        return true;
+    }
+
+    static_assert(denseAndInOrder(), "statusIndex must number the enumerators 0, 1, ...");
+    static_assert(statusIndex(static_cast<Status>(2)) == unknownStatusIndex, "");
+    static_assert(statusIndex(static_cast<Status>(300)) == unknownStatusIndex, "");
+
+    // Per-thread counters, merged on read. Each thread that records into a
+    // StatusHistogram gets a cache-line-aligned row of counters of its own,
+    // so recording is an increment nobody else writes to: a relaxed load and
+    // store, no read-modify-write and no false sharing. Rows outlive their
+    // threads, so counts from threads that have exited are still merged.
+    class StatusHistogram {
+    public:
+        using Counts = std::array<std::uint64_t, numStatuses + 1>;     // last: unknown values
+
+        StatusHistogram(): id(nextId.fetch_add(1, std::memory_order_relaxed)) {}
+
+        StatusHistogram(const StatusHistogram&) = delete;
+        StatusHistogram& operator=(const StatusHistogram&) = delete;
+
+        void record(Status s) {
+            auto& counter = localRow().counts[statusIndex(s)];
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        Counts snapshot() const {
+            Counts total{};
+            std::lock_guard<std::mutex> lock(m);
+            for (const auto& row : rows)
+                for (std::size_t i = 0; i < total.size(); ++i)
+                    total[i] += row->counts[i].load(std::memory_order_relaxed);
+            return total;
+        }
+
+        std::uint64_t count(Status s) const { return snapshot()[statusIndex(s)]; }
+
+    private:
+        struct alignas(64) Row {
+            Row() { for (auto& c : counts) c.store(0, std::memory_order_relaxed); }
+            std::array<std::atomic<std::uint64_t>, numStatuses + 1> counts;
+        };
+
+        // Each thread remembers the row it used last, tagged with the owning
+        // histogram's id rather than its address, which a later histogram
+        // might reuse.
+        Row& localRow() {
+            thread_local struct { std::uint64_t owner = 0; Row* row = nullptr; } cache;
+            if (cache.owner != id) {
+                std::lock_guard<std::mutex> lock(m);
+                auto& row = rowOf[std::this_thread::get_id()];
+                if (!row) {
+                    rows.push_back(std::make_unique<Row>());
+                    row = rows.back().get();
+                }
+                cache.owner = id;
+                cache.row = row;
+            }
+            return *cache.row;
+        }
+
+        static inline std::atomic<std::uint64_t> nextId{ 1 };
+
+        const std::uint64_t id;
+        mutable std::mutex m;
+        std::vector<std::unique_ptr<Row>> rows;
+        std::unordered_map<std::thread::id, Row*> rowOf;
+    };
 }
 
 
@@ -202,7 +492,71 @@ int main() {
 
     auto val = std::get<toUtType(UserInfoFileds::uiEmail)>(uInfo);
 
+    // scanning reputations: tuples versus a column
+    {
+        constexpr std::size_t n = 1'000'000;
+        std::vector<UserInfo> tuples;
+        EncodedUserInfoTable table;
+        tuples.reserve(n);
+        table.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            UserInfo info("user" + std::to_string(i % 1000),
+                          "user" + std::to_string(i) + "@example.com", i % 97);
+            table.push_back(info);
+            tuples.push_back(std::move(info));
+        }
+
+        using Clock = std::chrono::steady_clock;
+        auto t0 = Clock::now();
+        std::size_t tupleSum = 0;
+        for (const auto& info : tuples) tupleSum += std::get<toUtType(UserInfoFileds::uiReputation)>(info);
+        auto t1 = Clock::now();
+        std::size_t columnSum = 0;
+        table.scan<UserInfoFileds::uiReputation>([&columnSum](std::size_t r) { columnSum += r; });
+        auto t2 = Clock::now();
+
+        auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+        std::cout << "reputation scan: tuples " << ms(t1 - t0) << " ms, column " << ms(t2 - t1)
+                  << " ms (" << (tupleSum == columnSum ? "same" : "different") << " sums)" << '\n';
+
+        const auto& names = table.column<UserInfoFileds::uiName>();
+        std::cout << names.distinct() << " distinct names, " << names.count("user7")
+                  << " rows named user7; row 42's email: "
+                  << table.get<UserInfoFileds::uiEmail>(42) << '\n';
+    }
+
 
 
+    // counting statuses: hashing into an unordered_map versus an index into
+    // this thread's row of counters
+    {
+        constexpr std::size_t n = 10'000'000;
+        std::vector<Status> events(n);
+        std::uint32_t state = 7;
+        for (auto& e : events) {
+            state = state * 1664525u + 1013904223u;
+            e = allStatuses[(state >> 16) % numStatuses];
+        }
+
+        using Clock = std::chrono::steady_clock;
+        auto t0 = Clock::now();
+        std::unordered_map<Status, std::uint64_t> hashed;
+        for (auto e : events) ++hashed[e];
+        auto t1 = Clock::now();
+        StatusHistogram histogram;
+        for (auto e : events) histogram.record(e);
+        auto t2 = Clock::now();
+
+        auto nsPer = [n](Clock::duration d) { return std::chrono::duration<double, std::nano>(d).count() / n; };
+        std::cout << "status counting: unordered_map " << nsPer(t1 - t0)
+                  << " ns, StatusHistogram " << nsPer(t2 - t1) << " ns per event" << '\n';
+
+        auto counts = histogram.snapshot();
+        bool same = true;
+        for (auto s : allStatuses) same = same && counts[statusIndex(s)] == hashed[s];
+        std::cout << "counts " << (same ? "agree" : "DISAGREE")
+                  << "; indeterminate: " << histogram.count(Status::indeterminate) << '\n';
+    }
+
     return 0;
 }
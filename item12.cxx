@@ -4,6 +4,20 @@
 #include <mutex>
 #include <unordered_map>
 #include <list>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ITEM12_X86_DISPATCH 1
+#endif
 
 
 // ITEM 12: Declare overriding functions override.
@@ -230,6 +244,292 @@ namespace item12 {
         };
     };
 
+    // Bulk numeric kernels over a Widget's values. Each comes in a scalar,
+    // an AVX2/FMA and an AVX-512 version; which one runs is decided once,
+    // from the CPU the program finds itself on, and recorded in a table of
+    // function pointers.
+    namespace kernels {
+        struct Table {
+            const char* name;
+            double (*sum)(const double* x, std::size_t n);
+            double (*dot)(const double* x, const double* y, std::size_t n);
+            void (*scale)(double* x, std::size_t n, double a);
+            void (*axpy)(double a, const double* x, double* y, std::size_t n);    // y += a * x
+            void (*minMax)(const double* x, std::size_t n, double& lo, double& hi);
+        };
+
+        static double sumScalar(const double* x, std::size_t n) {
+            double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                s0 += x[i]; s1 += x[i + 1]; s2 += x[i + 2]; s3 += x[i + 3];
+            }
+            for (; i < n; ++i) s0 += x[i];
+            return (s0 + s1) + (s2 + s3);
+        }
+
+        static double dotScalar(const double* x, const double* y, std::size_t n) {
+            double s0 = 0, s1 = 0;
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                s0 += x[i] * y[i]; s1 += x[i + 1] * y[i + 1];
+            }
+            for (; i < n; ++i) s0 += x[i] * y[i];
+            return s0 + s1;
+        }
+
+        static void scaleScalar(double* x, std::size_t n, double a) {
+            for (std::size_t i = 0; i < n; ++i) x[i] *= a;
+        }
+
+        static void axpyScalar(double a, const double* x, double* y, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) y[i] += a * x[i];
+        }
+
+        static void minMaxScalar(const double* x, std::size_t n, double& lo, double& hi) {
+            for (std::size_t i = 0; i < n; ++i) {
+                lo = std::min(lo, x[i]);
+                hi = std::max(hi, x[i]);
+            }
+        }
+
+#ifdef ITEM12_X86_DISPATCH
+        __attribute__((target("avx2,fma")))
+        static double horizontalSum(__m256d v) {
+            auto pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+            return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+        }
+
+        __attribute__((target("avx2,fma")))
+        static double sumAVX2(const double* x, std::size_t n) {
+            auto a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                a0 = _mm256_add_pd(a0, _mm256_loadu_pd(x + i));
+                a1 = _mm256_add_pd(a1, _mm256_loadu_pd(x + i + 4));
+            }
+            return horizontalSum(_mm256_add_pd(a0, a1)) + sumScalar(x + i, n - i);
+        }
+
+        __attribute__((target("avx2,fma")))
+        static double dotAVX2(const double* x, const double* y, std::size_t n) {
+            auto a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                a0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), a0);
+                a1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4), a1);
+            }
+            return horizontalSum(_mm256_add_pd(a0, a1)) + dotScalar(x + i, y + i, n - i);
+        }
+
+        __attribute__((target("avx2,fma")))
+        static void scaleAVX2(double* x, std::size_t n, double a) {
+            auto va = _mm256_set1_pd(a);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) _mm256_storeu_pd(x + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), va));
+            scaleScalar(x + i, n - i, a);
+        }
+
+        __attribute__((target("avx2,fma")))
+        static void axpyAVX2(double a, const double* x, double* y, std::size_t n) {
+            auto va = _mm256_set1_pd(a);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+                _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+            axpyScalar(a, x + i, y + i, n - i);
+        }
+
+        __attribute__((target("avx2,fma")))
+        static void minMaxAVX2(const double* x, std::size_t n, double& lo, double& hi) {
+            auto vlo = _mm256_set1_pd(lo), vhi = _mm256_set1_pd(hi);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                auto v = _mm256_loadu_pd(x + i);
+                vlo = _mm256_min_pd(vlo, v);
+                vhi = _mm256_max_pd(vhi, v);
+            }
+            double los[4], his[4];
+            _mm256_storeu_pd(los, vlo);
+            _mm256_storeu_pd(his, vhi);
+            for (auto j = 0; j < 4; ++j) {
+                lo = std::min(lo, los[j]);
+                hi = std::max(hi, his[j]);
+            }
+            minMaxScalar(x + i, n - i, lo, hi);
+        }
+
+        // AVX-512 handles the tail with masked loads and stores. The lanes
+        // are reduced through memory; GCC 12's _mm512_reduce_* set off
+        // -Wuninitialized inside its own header.
+        __attribute__((target("avx512f")))
+        static double laneSum(__m512d v) {
+            double lanes[8];
+            _mm512_storeu_pd(lanes, v);
+            return sumScalar(lanes, 8);
+        }
+
+        __attribute__((target("avx512f")))
+        static double sumAVX512(const double* x, std::size_t n) {
+            auto a0 = _mm512_setzero_pd(), a1 = _mm512_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                a0 = _mm512_add_pd(a0, _mm512_loadu_pd(x + i));
+                a1 = _mm512_add_pd(a1, _mm512_loadu_pd(x + i + 8));
+            }
+            for (; i < n; i += 8) {
+                auto m = static_cast<__mmask8>(n - i >= 8 ? 0xFF : (1u << (n - i)) - 1);
+                a0 = _mm512_add_pd(a0, _mm512_maskz_loadu_pd(m, x + i));
+            }
+            return laneSum(_mm512_add_pd(a0, a1));
+        }
+
+        __attribute__((target("avx512f")))
+        static double dotAVX512(const double* x, const double* y, std::size_t n) {
+            auto a0 = _mm512_setzero_pd(), a1 = _mm512_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                a0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), a0);
+                a1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8), a1);
+            }
+            for (; i < n; i += 8) {
+                auto m = static_cast<__mmask8>(n - i >= 8 ? 0xFF : (1u << (n - i)) - 1);
+                a0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, x + i), _mm512_maskz_loadu_pd(m, y + i), a0);
+            }
+            return laneSum(_mm512_add_pd(a0, a1));
+        }
+
+        __attribute__((target("avx512f")))
+        static void scaleAVX512(double* x, std::size_t n, double a) {
+            auto va = _mm512_set1_pd(a);
+            for (std::size_t i = 0; i < n; i += 8) {
+                auto m = static_cast<__mmask8>(n - i >= 8 ? 0xFF : (1u << (n - i)) - 1);
+                _mm512_mask_storeu_pd(x + i, m, _mm512_mul_pd(_mm512_maskz_loadu_pd(m, x + i), va));
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        static void axpyAVX512(double a, const double* x, double* y, std::size_t n) {
+            auto va = _mm512_set1_pd(a);
+            for (std::size_t i = 0; i < n; i += 8) {
+                auto m = static_cast<__mmask8>(n - i >= 8 ? 0xFF : (1u << (n - i)) - 1);
+                _mm512_mask_storeu_pd(y + i, m, _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(m, x + i),
+                                                                 _mm512_maskz_loadu_pd(m, y + i)));
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        static void minMaxAVX512(const double* x, std::size_t n, double& lo, double& hi) {
+            auto vlo = _mm512_set1_pd(lo), vhi = _mm512_set1_pd(hi);
+            for (std::size_t i = 0; i < n; i += 8) {
+                auto m = static_cast<__mmask8>(n - i >= 8 ? 0xFF : (1u << (n - i)) - 1);
+                auto v = _mm512_maskz_loadu_pd(m, x + i);
+                vlo = _mm512_mask_min_pd(vlo, m, vlo, v);   // masked-off lanes keep
+                vhi = _mm512_mask_max_pd(vhi, m, vhi, v);   // their old values
+            }
+            double los[8], his[8];
+            _mm512_storeu_pd(los, vlo);
+            _mm512_storeu_pd(his, vhi);
+            for (auto j = 0; j < 8; ++j) {
+                lo = std::min(lo, los[j]);
+                hi = std::max(hi, his[j]);
+            }
+        }
+#endif
+
+        inline const Table& table() noexcept {
+            static const Table t = []() -> Table {
+#ifdef ITEM12_X86_DISPATCH
+                if (__builtin_cpu_supports("avx512f"))
+                    return { "avx512", &sumAVX512, &dotAVX512, &scaleAVX512, &axpyAVX512, &minMaxAVX512 };
+                if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+                    return { "avx2", &sumAVX2, &dotAVX2, &scaleAVX2, &axpyAVX2, &minMaxAVX2 };
+#endif
+                return { "scalar", &sumScalar, &dotScalar, &scaleScalar, &axpyScalar, &minMaxScalar };
+            }();
+            return t;
+        }
+    }
+
+    // Fork-join pool for the kernels' parallel mode. run(parts, f) calls
+    // f(0) ... f(parts - 1) spread over the workers and the calling thread,
+    // and returns once they've all finished. The kernels don't throw, and
+    // neither may f.
+    class KernelPool {
+    public:
+        explicit KernelPool(unsigned numThreads) {
+            for (unsigned i = 1; i < numThreads; ++i)   // the caller is a thread, too
+                workers.emplace_back([this] { workerLoop(); });
+        }
+
+        ~KernelPool() {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                stopping = true;
+            }
+            workAvailable.notify_all();
+            for (auto& t : workers) t.join();
+        }
+
+        KernelPool(const KernelPool&) = delete;
+        KernelPool& operator=(const KernelPool&) = delete;
+
+        static KernelPool& instance() {
+            static KernelPool pool(std::max(1u, std::thread::hardware_concurrency()));
+            return pool;
+        }
+
+        std::size_t size() const noexcept { return workers.size() + 1; }
+
+        void run(std::size_t parts, const std::function<void(std::size_t)>& f) {
+            std::lock_guard<std::mutex> oneJobAtATime(runMutex);
+            {
+                std::lock_guard<std::mutex> lock(m);
+                job = &f;
+                nextPart = 0;
+                numParts = parts;
+                remaining = parts;
+            }
+            workAvailable.notify_all();
+
+            std::unique_lock<std::mutex> lock(m);
+            runParts(lock);
+            jobDone.wait(lock, [this] { return remaining == 0; });
+            job = nullptr;
+        }
+
+    private:
+        void workerLoop() {
+            std::unique_lock<std::mutex> lock(m);
+            for (;;) {
+                workAvailable.wait(lock, [this] { return stopping || (job && nextPart < numParts); });
+                if (stopping) return;
+                runParts(lock);
+            }
+        }
+
+        // called, and returns, with the lock held
+        void runParts(std::unique_lock<std::mutex>& lock) {
+            while (job && nextPart < numParts) {
+                auto part = nextPart++;
+                auto f = job;
+                lock.unlock();
+                (*f)(part);
+                lock.lock();
+                if (--remaining == 0) jobDone.notify_all();
+            }
+        }
+
+        std::mutex runMutex;
+        std::mutex m;
+        std::condition_variable workAvailable, jobDone;
+        const std::function<void(std::size_t)>* job = nullptr;
+        std::size_t nextPart = 0, numParts = 0, remaining = 0;
+        bool stopping = false;
+        std::vector<std::thread> workers;
+    };
+
+    enum class Execution { sequential, parallel, automatic };
+
     // reference qualifiers
     class Widget {
     public:
@@ -237,13 +537,136 @@ namespace item12 {
         // void doWork() &&; // this version of doWork applies only when *this is an rvalue
 
         using DataType = std::vector<double>;
+
+        Widget() = default;
+        explicit Widget(DataType values): values(std::move(values)) {}
+
         DataType& data() & { return values; } // for lvalue Widgets, return lvalue
         DataType data() && { return std::move(values); } // for rvalue Widgets, return rvalue
 
+        // Bulk operations on values. Execution::automatic goes parallel for
+        // vectors of at least parallelThreshold elements when there's more
+        // than one thread to use. Parallel reductions add up partial results
+        // per chunk, so their rounding can differ from sequential ones in the
+        // last bits. minMax of no values is { +inf, -inf }; NaNs aren't
+        // treated specially.
+        static constexpr std::size_t parallelThreshold = std::size_t{ 1 } << 20;
+
+        double sum(Execution exec = Execution::automatic) const;
+        double dot(const Widget& rhs, Execution exec = Execution::automatic) const;
+        std::pair<double, double> minMax(Execution exec = Execution::automatic) const;
+        void scale(double a, Execution exec = Execution::automatic);
+        void axpy(double a, const Widget& x, Execution exec = Execution::automatic); // values += a * x
+
+        // scaled values: lvalue Widgets copy theirs, rvalue Widgets hand over
+        // their buffer, scaled in place
+        DataType scaled(double a, Execution exec = Execution::automatic) const &;
+        DataType scaled(double a, Execution exec = Execution::automatic) &&;
+
     private:
         DataType values;
     };
 
+    namespace kernels {
+        inline bool goParallel(Execution exec, std::size_t n) {
+            if (exec == Execution::sequential) return false;
+            if (KernelPool::instance().size() == 1) return false;
+            return exec == Execution::parallel || n >= Widget::parallelThreshold;
+        }
+
+        // Splits [0, n) into one chunk per pool thread, at multiples of 8
+        // doubles so that no two chunks write to the same cache line, and
+        // calls f(part, begin, end) for each.
+        template<typename F>
+        void forChunks(std::size_t n, F&& f) {
+            auto& pool = KernelPool::instance();
+            auto parts = pool.size();
+            auto chunk = ((n + parts - 1) / parts + 7) / 8 * 8;
+            pool.run(parts, [&](std::size_t part) {
+                auto begin = std::min(n, part * chunk);
+                auto end = std::min(n, begin + chunk);
+                f(part, begin, end);
+            });
+        }
+
+        template<typename Combine>
+        double reduce(std::size_t n, Combine combine) {
+            std::vector<double> partials(KernelPool::instance().size());
+            forChunks(n, [&](std::size_t part, std::size_t begin, std::size_t end) {
+                partials[part] = combine(begin, end);
+            });
+            double total = 0;
+            for (auto p : partials) total += p;
+            return total;
+        }
+    }
+
+    double Widget::sum(Execution exec) const {
+        auto x = values.data();
+        if (!kernels::goParallel(exec, values.size())) return kernels::table().sum(x, values.size());
+        return kernels::reduce(values.size(), [x](std::size_t begin, std::size_t end) {
+            return kernels::table().sum(x + begin, end - begin);
+        });
+    }
+
+    double Widget::dot(const Widget& rhs, Execution exec) const {
+        if (rhs.values.size() != values.size()) throw std::invalid_argument("Widget::dot: sizes differ");
+        auto x = values.data();
+        auto y = rhs.values.data();
+        if (!kernels::goParallel(exec, values.size())) return kernels::table().dot(x, y, values.size());
+        return kernels::reduce(values.size(), [x, y](std::size_t begin, std::size_t end) {
+            return kernels::table().dot(x + begin, y + begin, end - begin);
+        });
+    }
+
+    std::pair<double, double> Widget::minMax(Execution exec) const {
+        auto lo = std::numeric_limits<double>::infinity();
+        auto hi = -lo;
+        auto x = values.data();
+        if (!kernels::goParallel(exec, values.size())) {
+            kernels::table().minMax(x, values.size(), lo, hi);
+            return { lo, hi };
+        }
+
+        std::vector<std::pair<double, double>> partials(KernelPool::instance().size(), { lo, hi });
+        kernels::forChunks(values.size(), [&](std::size_t part, std::size_t begin, std::size_t end) {
+            kernels::table().minMax(x + begin, end - begin, partials[part].first, partials[part].second);
+        });
+        for (const auto& p : partials) {
+            lo = std::min(lo, p.first);
+            hi = std::max(hi, p.second);
+        }
+        return { lo, hi };
+    }
+
+    void Widget::scale(double a, Execution exec) {
+        auto x = values.data();
+        if (!kernels::goParallel(exec, values.size())) return kernels::table().scale(x, values.size(), a);
+        kernels::forChunks(values.size(), [x, a](std::size_t, std::size_t begin, std::size_t end) {
+            kernels::table().scale(x + begin, end - begin, a);
+        });
+    }
+
+    void Widget::axpy(double a, const Widget& x, Execution exec) {
+        if (x.values.size() != values.size()) throw std::invalid_argument("Widget::axpy: sizes differ");
+        auto px = x.values.data();
+        auto py = values.data();
+        if (!kernels::goParallel(exec, values.size())) return kernels::table().axpy(a, px, py, values.size());
+        kernels::forChunks(values.size(), [a, px, py](std::size_t, std::size_t begin, std::size_t end) {
+            kernels::table().axpy(a, px + begin, py + begin, end - begin);
+        });
+    }
+
+    Widget::DataType Widget::scaled(double a, Execution exec) const & {
+        Widget copy(*this);
+        return std::move(copy).scaled(a, exec);
+    }
+
+    Widget::DataType Widget::scaled(double a, Execution exec) && {
+        scale(a, exec);
+        return std::move(values);
+    }
+
 
     Widget makeWidget() {
         return Widget();
@@ -262,6 +685,21 @@ int main() {
 
     auto vals2 = makeWidget().data(); // calls rvalue overload for Widget::data, move-constructor vals2
 
+    // bulk kernels
+    Widget big(Widget::DataType(Widget::parallelThreshold * 2, 0.5));
+    Widget ones(Widget::DataType(big.data().size(), 1.0));
+
+    big.axpy(2.0, ones);                        // every value is now 2.5
+    auto range = big.minMax();
+    std::cout << "kernels: " << kernels::table().name
+              << ", threads: " << KernelPool::instance().size() << '\n'
+              << "sum " << big.sum() << ", dot " << big.dot(ones)
+              << ", min " << range.first << ", max " << range.second << '\n';
+
+    // the temporary's buffer is scaled in place and moved out, not copied
+    auto scaledVals = Widget(std::move(big).data()).scaled(4.0);
+    std::cout << "scaled[0] " << scaledVals[0] << '\n';
+
 
     return 0;
 }
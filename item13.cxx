@@ -5,6 +5,16 @@
 #include <mutex>
 #include <unordered_map>
 #include <list>
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ITEM13_SSE2 1
+#endif
 
 
 // ITEM 13: Prefer const_iterators to iterators.
@@ -273,19 +283,191 @@ namespace item13 {
        auto it = std::find(values.cbegin(), values.cend(), 1983);
 
        // generic code, C++14
+       //
+       // How the target is found is picked during compilation, by tag
+       // dispatch: contiguous containers of arithmetic values, searched for a
+       // value of the element type, use SSE2, a block of elements per
+       // comparison, and everything else uses std::find.
+       template<typename C, typename = void>
+       struct IsContiguousArithmetic: std::false_type {};
+
+       template<typename C>
+       struct IsContiguousArithmetic<C, std::void_t<decltype(std::data(std::declval<const C&>()))>>
+       : std::is_arithmetic<std::remove_const_t<
+             std::remove_pointer_t<decltype(std::data(std::declval<const C&>()))>>> {};
+
+       // first element equal to value in [first, last), or last
+       template<typename T>
+       const T* simdFind(const T* first, const T* last, T value) noexcept {
+#ifdef ITEM13_SSE2
+           if constexpr (std::is_integral<T>::value && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4)) {
+               constexpr std::size_t lanes = 16 / sizeof(T);
+               auto needle = sizeof(T) == 1 ? _mm_set1_epi8(static_cast<char>(value))
+                           : sizeof(T) == 2 ? _mm_set1_epi16(static_cast<short>(value))
+                           :                  _mm_set1_epi32(static_cast<int>(value));
+               auto equal = [needle](const T* p) {
+                   auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                   if constexpr (sizeof(T) == 1) return _mm_cmpeq_epi8(v, needle);
+                   else if constexpr (sizeof(T) == 2) return _mm_cmpeq_epi16(v, needle);
+                   else return _mm_cmpeq_epi32(v, needle);
+               };
+               auto firstIn = [](const T* p, int mask) { return p + __builtin_ctz(mask) / sizeof(T); };
+
+               // four blocks per test while there's room, then one at a time
+               for (; static_cast<std::size_t>(last - first) >= 4 * lanes; first += 4 * lanes) {
+                   auto e0 = equal(first), e1 = equal(first + lanes);
+                   auto e2 = equal(first + 2 * lanes), e3 = equal(first + 3 * lanes);
+                   auto any = _mm_or_si128(_mm_or_si128(e0, e1), _mm_or_si128(e2, e3));
+                   if (_mm_movemask_epi8(any)) {
+                       if (auto m = _mm_movemask_epi8(e0)) return firstIn(first, m);
+                       if (auto m = _mm_movemask_epi8(e1)) return firstIn(first + lanes, m);
+                       if (auto m = _mm_movemask_epi8(e2)) return firstIn(first + 2 * lanes, m);
+                       return firstIn(first + 3 * lanes, _mm_movemask_epi8(e3));
+                   }
+               }
+               for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+                   if (auto m = _mm_movemask_epi8(equal(first))) return firstIn(first, m);
+               }
+           }
+#endif
+           return std::find(first, last, value);
+       }
+
+       template<typename C, typename V>
+       auto findPosition(const C& container, const V& targetVal, std::true_type) {
+           using std::cbegin;
+           auto first = std::data(container);
+           auto found = simdFind(first, first + std::size(container), targetVal);
+           return cbegin(container) + (found - first);
+       }
+
+       template<typename C, typename V>
+       auto findPosition(const C& container, const V& targetVal, std::false_type) {
+           using std::cbegin;
+           using std::cend;
+           return std::find(cbegin(container), cend(container), targetVal);
+       }
+
+       // only when the value already has the element type: converting it
+       // first would change what matches (1.5 would find 1 in a vector<int>)
+       template<typename C, typename V, typename = void>
+       struct CanSimdFind: std::false_type {};
+
+       template<typename C, typename V>
+       struct CanSimdFind<C, V, std::enable_if_t<IsContiguousArithmetic<C>::value>>
+       : std::is_same<std::decay_t<V>, std::remove_const_t<
+             std::remove_pointer_t<decltype(std::data(std::declval<const C&>()))>>> {};
+
+       template<typename C, typename V>
+       auto findPosition(const C& container, const V& targetVal) {
+           return findPosition(container, targetVal, CanSimdFind<C, V>());
+       }
+
        template<typename C, typename V>
        void findAndInsert(C& container,
                           const V& targetVal,
                           const V& insertVal)
        {
+           auto it = findPosition(container, targetVal);
+
+           container.insert(it, insertVal);
+       }
+
+       // For containers the caller knows to be sorted, pass sorted as the
+       // first argument: the target is found with a binary search. The result
+       // is the position std::find would give: the first element equal to
+       // targetVal, or the end if there isn't one.
+       struct SortedTag {};
+       constexpr SortedTag sorted{};
+
+       template<typename C, typename V>
+       auto findPosition(SortedTag, const C& container, const V& targetVal) {
+           using std::cbegin;
+           using std::cend;
+           auto it = std::lower_bound(cbegin(container), cend(container), targetVal);
+           return it != cend(container) && !(targetVal < *it) ? it : cend(container);
+       }
+
+       template<typename C, typename V>
+       void findAndInsert(SortedTag, C& container,
+                          const V& targetVal,
+                          const V& insertVal)
+       {
+           container.insert(findPosition(sorted, container, targetVal), insertVal);
+       }
+
+       // k inserts at once. insertions is a range of (targetVal, insertVal)
+       // pairs; each insertVal goes before the first element equal to its
+       // targetVal in the container as it was on entry (or at the end), and
+       // values bound for the same spot keep their order in insertions. The
+       // container grows once, and each of its elements moves at most once,
+       // instead of k inserts each shifting the tail.
+       //
+       // Needs a resizable container (std::vector, std::deque, std::string)
+       // of default-constructible values.
+       namespace detail {
+           template<typename C, typename Positions, typename Pairs>
+           void mergeInsertions(C& container, Positions& positions, const Pairs& insertions) {
+               // positions[i] is where the i-th insertion goes; order the
+               // insertions by it, stably
+               std::vector<std::size_t> order(positions.size());
+               for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+               std::stable_sort(order.begin(), order.end(),
+                                [&positions](std::size_t a, std::size_t b) { return positions[a] < positions[b]; });
+
+               std::vector<const typename C::value_type*> values;
+               values.reserve(order.size());
+               for (const auto& p : insertions) values.push_back(&p.second);
+
+               // fill from the back: move each stretch of old elements to its
+               // final place, then drop in the insertion in front of it
+               auto n = container.size();
+               container.resize(n + order.size());
+               auto src = n;
+               auto dst = n + order.size();
+               for (auto i = order.size(); i-- > 0; ) {
+                   auto pos = positions[order[i]];
+                   auto b = container.begin();
+                   std::move_backward(b + pos, b + src, b + dst);
+                   dst -= src - pos;
+                   container[--dst] = *values[order[i]];
+                   src = pos;
+               }
+           }
+       }
+
+       template<typename C, typename Pairs>
+       void findAndInsertMany(C& container, const Pairs& insertions) {
+           using V = typename C::value_type;
            using std::cbegin;
            using std::cend;
 
-           auto it = std::find(cbegin(container),
-                               cend(container),
-                               targetVal);
+           // one pass over the container finds the first occurrence of
+           // every target
+           std::unordered_map<V, std::size_t> firstOf;
+           for (const auto& p : insertions) firstOf.emplace(p.first, container.size());
+           auto unresolved = firstOf.size();
+           std::size_t index = 0;
+           for (auto it = cbegin(container); it != cend(container) && unresolved != 0; ++it, ++index) {
+               auto pos = firstOf.find(*it);
+               if (pos != firstOf.end() && pos->second == container.size()) {
+                   pos->second = index;
+                   --unresolved;
+               }
+           }
+
+           std::vector<std::size_t> positions;
+           for (const auto& p : insertions) positions.push_back(firstOf[p.first]);
+           detail::mergeInsertions(container, positions, insertions);
+       }
 
-           container.insert(it, insertVal);
+       template<typename C, typename Pairs>
+       void findAndInsertMany(SortedTag, C& container, const Pairs& insertions) {
+           using std::cbegin;
+           std::vector<std::size_t> positions;
+           for (const auto& p : insertions)
+               positions.push_back(static_cast<std::size_t>(findPosition(sorted, container, p.first) - cbegin(container)));
+           detail::mergeInsertions(container, positions, insertions);
        }
 
        // non-member cbegin in c++11
@@ -307,6 +489,41 @@ int main() {
     cxx98::values.insert(cxx98::it, 1998);
     cxx11::values.insert(cxx11::it, 1983);
 
+    // one insert behind a SIMD find, and a thousand of them merged at once
+    {
+        using namespace cxx11;
+        using Clock = std::chrono::steady_clock;
+        auto us = [](Clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); };
+
+        std::vector<int> big(1'000'000);
+        for (std::size_t i = 0; i < big.size(); ++i) big[i] = static_cast<int>(2 * i);
+
+        auto t0 = Clock::now();
+        auto viaFind = std::find(big.cbegin(), big.cend(), -1);
+        auto t1 = Clock::now();
+        auto viaSimd = findPosition(big, -1);
+        auto t2 = Clock::now();
+        std::cout << "missing value: std::find " << us(t1 - t0) << " us, simdFind " << us(t2 - t1)
+                  << " us" << (viaFind == viaSimd ? "" : "  MISMATCH") << '\n';
+
+        std::vector<std::pair<int, int>> insertions;
+        for (auto i = 0; i < 1000; ++i) {                   // odd values in front of
+            auto target = 2 * (i * 997 % 1'000'000);        // even targets: still sorted
+            insertions.emplace_back(target, target - 1);
+        }
+
+        auto oneByOne = big;
+        auto t3 = Clock::now();
+        for (const auto& p : insertions) findAndInsert(sorted, oneByOne, p.first, p.second);
+        auto t4 = Clock::now();
+        auto merged = big;
+        findAndInsertMany(sorted, merged, insertions);
+        auto t5 = Clock::now();
+        std::cout << "1000 inserts into 1M ints: one by one " << us(t4 - t3) / 1000
+                  << " ms, findAndInsertMany " << us(t5 - t4) / 1000 << " ms"
+                  << (oneByOne == merged ? "" : "  MISMATCH") << '\n';
+    }
+
 
 
     return 0;
@@ -5,6 +5,10 @@
 #include <mutex>
 #include <unordered_map>
 #include <list>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 
 
 
@@ -385,6 +389,180 @@ namespace item15 {
 
         return result;
     }
+
+    // Tables computed during compilation. makeTable<N>(f) is a constexpr
+    // function returning the std::array { f(0), f(1), ..., f(N - 1) }; bind
+    // the result to a constexpr object and the whole table is a compile-time
+    // constant, placed in read-only data by the compiler, with no startup cost.
+    template<std::size_t N, typename F>
+    constexpr auto makeTable(F f) {
+        std::array<decltype(f(std::size_t{ 0 })), N> table{};
+        for (std::size_t i = 0; i < N; ++i) table[i] = f(i);
+        return table;
+    }
+
+    // powers of base: powers<3, 6>[i] == pow(3, i)
+    template<int Base, std::size_t N>
+    constexpr auto powers = makeTable<N>([](std::size_t i) { return pow(Base, static_cast<int>(i)); });
+
+    static_assert(powers<3, numConds + 1>[numConds] == pow(3, numConds), "");
+
+    // Rows x Cols grid of Points starting at origin, step apart; index it
+    // with row * Cols + col.
+    template<std::size_t Rows, std::size_t Cols>
+    constexpr auto pointGrid(const Point& origin, const Point& step) noexcept {
+        return makeTable<Rows * Cols>([origin, step](std::size_t i) {
+            return Point(origin.xValue() + static_cast<double>(i % Cols) * step.xValue(),
+                         origin.yValue() + static_cast<double>(i / Cols) * step.yValue());
+        });
+    }
+
+    template<std::size_t N>
+    constexpr auto midPoints(const std::array<Point, N>& points, const Point& center) noexcept {
+        return makeTable<N>([&points, center](std::size_t i) { return midPoint(points[i], center); });
+    }
+
+    template<std::size_t N>
+    constexpr auto reflections(const std::array<Point, N>& points) noexcept {
+        return makeTable<N>([&points](std::size_t i) { return reflection(points[i]); });
+    }
+
+    // CRC-32 (the reflected 0xEDB88320 polynomial used by zip and Ethernet):
+    // the bitwise definition, the 256 entry table derived from it, and the
+    // byte-at-a-time version that uses the table.
+    constexpr std::uint32_t crc32Step(std::uint32_t crc) noexcept {
+        return (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+
+    constexpr std::uint32_t crc32Bitwise(const unsigned char* data, std::size_t size) noexcept {
+        std::uint32_t crc = 0xFFFFFFFFu;
+        for (std::size_t i = 0; i < size; ++i) {
+            crc ^= data[i];
+            for (auto bit = 0; bit < 8; ++bit) crc = crc32Step(crc);
+        }
+        return ~crc;
+    }
+
+    constexpr auto crc32Table = makeTable<256>([](std::size_t i) {
+        auto crc = static_cast<std::uint32_t>(i);
+        for (auto bit = 0; bit < 8; ++bit) crc = crc32Step(crc);
+        return crc;
+    });
+
+    constexpr std::uint32_t crc32(const unsigned char* data, std::size_t size) noexcept {
+        std::uint32_t crc = 0xFFFFFFFFu;
+        for (std::size_t i = 0; i < size; ++i) crc = (crc >> 8) ^ crc32Table[(crc ^ data[i]) & 0xFFu];
+        return ~crc;
+    }
+
+    constexpr unsigned char crcCheck[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    static_assert(crc32Table[1] == 0x77073096u, "");
+    static_assert(crc32(crcCheck, sizeof(crcCheck)) == 0xCBF43926u, "");
+    static_assert(crc32Bitwise(crcCheck, sizeof(crcCheck)) == 0xCBF43926u, "");
+
+    // bit reversal, a bit at a time and through a byte table
+    constexpr std::uint8_t reverseBitsLoop(std::uint8_t b) noexcept {
+        std::uint8_t r = 0;
+        for (auto bit = 0; bit < 8; ++bit) r = static_cast<std::uint8_t>((r << 1) | ((b >> bit) & 1u));
+        return r;
+    }
+
+    constexpr auto bitReverseTable = makeTable<256>([](std::size_t i) {
+        return reverseBitsLoop(static_cast<std::uint8_t>(i));
+    });
+
+    constexpr std::uint32_t reverseBits(std::uint32_t v) noexcept {
+        return static_cast<std::uint32_t>(bitReverseTable[v & 0xFFu]) << 24
+             | static_cast<std::uint32_t>(bitReverseTable[(v >> 8) & 0xFFu]) << 16
+             | static_cast<std::uint32_t>(bitReverseTable[(v >> 16) & 0xFFu]) << 8
+             | static_cast<std::uint32_t>(bitReverseTable[v >> 24]);
+    }
+
+    constexpr std::uint32_t reverseBitsLoop(std::uint32_t v) noexcept {
+        std::uint32_t r = 0;
+        for (auto bit = 0; bit < 32; ++bit) r = (r << 1) | ((v >> bit) & 1u);
+        return r;
+    }
+
+    static_assert(bitReverseTable[0x01] == 0x80, "");
+    static_assert(reverseBits(0x12345678u) == reverseBitsLoop(0x12345678u), "");
+
+    // Tables versus computing on the fly. The inputs come from a runtime
+    // sequence so that neither side can be folded away; each line reports
+    // the time per lookup or call, and flags a mismatch between the sides.
+    // Tables win where the computation loops (pow, CRC, bit reversal); a
+    // couple of multiply-adds, as for the Point grid, are cheaper than a load.
+    template<typename Table, typename Direct>
+    void compare(const char* label, std::size_t n, Table table, Direct direct) {
+        using Clock = std::chrono::steady_clock;
+        auto t0 = Clock::now();
+        auto tableSum = table(n);
+        auto t1 = Clock::now();
+        auto directSum = direct(n);
+        auto t2 = Clock::now();
+
+        auto nsPer = [n](Clock::duration d) { return std::chrono::duration<double, std::nano>(d).count() / n; };
+        std::cout << "  " << label << ": table " << nsPer(t1 - t0) << " ns, computed "
+                  << nsPer(t2 - t1) << " ns" << (tableSum == directSum ? "" : "  MISMATCH") << '\n';
+    }
+
+    void benchmarkTables() {
+        constexpr std::size_t n = 10'000'000;
+        std::vector<std::uint32_t> inputs(n);
+        std::uint32_t state = 12345;
+        for (auto& v : inputs) v = state = state * 1664525u + 1013904223u;
+
+        std::cout << "tables versus on-the-fly computation, per element" << '\n';
+
+        compare("pow(3, i % 20)", n,
+            [&](std::size_t n) {
+                long long sum = 0;
+                for (std::size_t i = 0; i < n; ++i) sum += powers<3, 20>[inputs[i] % 20];
+                return sum;
+            },
+            [&](std::size_t n) {
+                long long sum = 0;
+                for (std::size_t i = 0; i < n; ++i) sum += pow(3, static_cast<int>(inputs[i] % 20));
+                return sum;
+            });
+
+        constexpr auto grid = pointGrid<32, 32>(Point(-8, -8), Point(0.5, 0.5));
+        constexpr auto gridMids = midPoints(grid, Point(1, 1));
+        constexpr auto gridReflections = reflections(gridMids);
+
+        compare("reflection(midPoint(grid[i], c))", n,
+            [&](std::size_t n) {
+                double sum = 0;
+                for (std::size_t i = 0; i < n; ++i) sum += gridReflections[inputs[i] % grid.size()].xValue();
+                return sum;
+            },
+            [&](std::size_t n) {
+                double sum = 0;
+                for (std::size_t i = 0; i < n; ++i) {
+                    auto k = inputs[i] % grid.size();
+                    Point p(-8 + static_cast<double>(k % 32) * 0.5, -8 + static_cast<double>(k / 32) * 0.5);
+                    sum += reflection(midPoint(p, Point(1, 1))).xValue();
+                }
+                return sum;
+            });
+
+        auto bytes = reinterpret_cast<const unsigned char*>(inputs.data());
+        compare("crc32 per byte", n * sizeof(std::uint32_t),
+            [&](std::size_t n) { return crc32(bytes, n); },
+            [&](std::size_t n) { return crc32Bitwise(bytes, n); });
+
+        compare("reverseBits(uint32_t)", n,
+            [&](std::size_t n) {
+                std::uint32_t sum = 0;
+                for (std::size_t i = 0; i < n; ++i) sum += reverseBits(inputs[i]);
+                return sum;
+            },
+            [&](std::size_t n) {
+                std::uint32_t sum = 0;
+                for (std::size_t i = 0; i < n; ++i) sum += reverseBitsLoop(inputs[i]);
+                return sum;
+            });
+    }
 }
 
 int main() {
@@ -399,6 +577,12 @@ int main() {
 
     std::cout << reflectedMid.xValue() << '\n';
 
+    constexpr auto grid = pointGrid<4, 4>(p1, p2);              // all computed
+    constexpr auto mirrored = reflections(midPoints(grid, mid)); // during compilation
+    static_assert(mirrored[0].xValue() == reflection(midPoint(p1, mid)).xValue(), "");
+
+    benchmarkTables();
+
 
 
 
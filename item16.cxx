@@ -7,6 +7,19 @@
 #include <mutex>
 #include <unordered_map>
 #include <list>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <condition_variable>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 
 // ITEM 16: Make const member functions thread safe.
@@ -385,67 +398,591 @@ namespace item15 {
     }
 }
 
+// Contention instrumentation for mutexes and atomics. Build with
+// -DITEM16_INSTRUMENT_LOCKS and every InstrumentedMutex counts its
+// acquisitions, how many of them found it already held, and keeps histograms
+// of how long threads waited for it and how long they held it; every
+// InstrumentedAtomic counts its read-modify-write operations, how many had to
+// retry because another thread got in first, and how long the retries took.
+// Objects with the same name share one set of numbers, which outlives them,
+// and dumpJson writes them all out.
+//
+// Without the flag, InstrumentedMutex is a std::mutex and InstrumentedAtomic a
+// std::atomic, with a name that's ignored; nothing is recorded, and dumpJson
+// just says so. Code that waits on a condition variable should use the
+// ConditionVariable and MutexLock aliases, which follow the mutex type.
+namespace contention {
+#ifdef ITEM16_INSTRUMENT_LOCKS
+    constexpr bool enabled = true;
+
+    // power-of-two buckets of nanoseconds: bucket b counts durations in
+    // [2^(b-1), 2^b), the last one everything longer
+    class Histogram {
+    public:
+        static constexpr std::size_t numBuckets = 40;      // up to ~9 minutes
+
+        void record(std::uint64_t ns) noexcept {
+            std::size_t b = 0;
+            while (b + 1 < numBuckets && (ns >> b) != 0) ++b;
+            buckets[b].fetch_add(1, std::memory_order_relaxed);
+            total.fetch_add(ns, std::memory_order_relaxed);
+            auto m = max.load(std::memory_order_relaxed);
+            while (ns > m && !max.compare_exchange_weak(m, ns, std::memory_order_relaxed)) {}
+        }
+
+        void writeJson(std::ostream& os) const {
+            std::uint64_t count = 0;
+            for (auto& b : buckets) count += b.load(std::memory_order_relaxed);
+
+            os << "{\"count\": " << count
+               << ", \"total_ns\": " << total.load(std::memory_order_relaxed)
+               << ", \"max_ns\": " << max.load(std::memory_order_relaxed)
+               << ", \"buckets\": [";
+            auto first = true;
+            for (std::size_t b = 0; b < numBuckets; ++b) {
+                auto n = buckets[b].load(std::memory_order_relaxed);
+                if (n == 0) continue;
+                os << (first ? "" : ", ") << "{\"below_ns\": ";
+                if (b + 1 < numBuckets) os << (std::uint64_t{ 1 } << b); else os << "null";
+                os << ", \"count\": " << n << '}';
+                first = false;
+            }
+            os << "]}";
+        }
+
+    private:
+        std::array<std::atomic<std::uint64_t>, numBuckets> buckets{};
+        std::atomic<std::uint64_t> total{ 0 };
+        std::atomic<std::uint64_t> max{ 0 };
+    };
+
+    struct Stats {
+        enum class Kind { mutex, atomic };
+
+        Stats(std::string name, Kind kind) : name(std::move(name)), kind(kind) {}
+
+        const std::string name;
+        const Kind kind;
+        std::atomic<std::uint64_t> acquisitions{ 0 };   // locks, or RMW operations
+        std::atomic<std::uint64_t> contended{ 0 };      // ... that had to wait, or retry
+        Histogram wait;
+        Histogram hold;                                 // mutexes only
+    };
+
+    class Registry {
+    public:
+        static Registry& instance() {
+            static Registry* r = new Registry;          // never destroyed, so it can
+            return *r;                                  // be used from static dtors
+        }
+
+        Stats& stats(const char* name, Stats::Kind kind) {
+            std::lock_guard<std::mutex> g(m);
+            for (auto& s : all) {
+                if (s->kind == kind && s->name == name) return *s;
+            }
+            all.push_back(std::make_unique<Stats>(name, kind));
+            return *all.back();
+        }
+
+        void writeJson(std::ostream& os) {
+            std::lock_guard<std::mutex> g(m);
+            os << "{\"enabled\": true, \"objects\": [";
+            for (std::size_t i = 0; i < all.size(); ++i) {
+                auto& s = *all[i];
+                os << (i ? ",\n  " : "\n  ") << "{\"name\": \"" << s.name << "\", \"kind\": \""
+                   << (s.kind == Stats::Kind::mutex ? "mutex" : "atomic") << "\""
+                   << ", \"acquisitions\": " << s.acquisitions.load(std::memory_order_relaxed)
+                   << ", \"contended\": " << s.contended.load(std::memory_order_relaxed)
+                   << ", \"wait\": ";
+                s.wait.writeJson(os);
+                if (s.kind == Stats::Kind::mutex) {
+                    os << ", \"hold\": ";
+                    s.hold.writeJson(os);
+                }
+                os << '}';
+            }
+            os << "\n]}\n";
+        }
+
+    private:
+        std::mutex m;
+        std::vector<std::unique_ptr<Stats>> all;
+    };
+
+    inline std::uint64_t nowNs() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    class InstrumentedMutex {
+    public:
+        explicit InstrumentedMutex(const char* name)
+            : stats(&Registry::instance().stats(name, Stats::Kind::mutex)) {}
+
+        InstrumentedMutex(const InstrumentedMutex&) = delete;
+        InstrumentedMutex& operator=(const InstrumentedMutex&) = delete;
+
+        void lock() {
+            if (!m.try_lock()) {
+                auto start = nowNs();
+                m.lock();
+                acquiredAt = nowNs();
+                stats->contended.fetch_add(1, std::memory_order_relaxed);
+                stats->wait.record(acquiredAt - start);
+            } else {
+                acquiredAt = nowNs();
+            }
+            stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        bool try_lock() {
+            if (!m.try_lock()) return false;
+            acquiredAt = nowNs();
+            stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        void unlock() {
+            stats->hold.record(nowNs() - acquiredAt);   // still ours to read
+            m.unlock();
+        }
+
+    private:
+        std::mutex m;
+        Stats* stats;
+        std::uint64_t acquiredAt = 0;                   // written by the owner only
+    };
+
+    using ConditionVariable = std::condition_variable_any;
+    using MutexLock = std::unique_lock<InstrumentedMutex>;
+
+    // Read-modify-write operations are compare-exchange loops, so a retry
+    // means another thread changed the value in between; only a retried
+    // operation reads the clock. Plain loads and stores aren't counted.
+    template<typename T>
+    class InstrumentedAtomic {
+    public:
+        explicit InstrumentedAtomic(const char* name, T desired = T())
+            : value(desired), stats(&Registry::instance().stats(name, Stats::Kind::atomic)) {}
+
+        InstrumentedAtomic(const InstrumentedAtomic&) = delete;
+        InstrumentedAtomic& operator=(const InstrumentedAtomic&) = delete;
+
+        T load(std::memory_order order = std::memory_order_seq_cst) const noexcept { return value.load(order); }
+        void store(T desired, std::memory_order order = std::memory_order_seq_cst) noexcept { value.store(desired, order); }
+        operator T() const noexcept { return load(); }
+        T operator=(T desired) noexcept { store(desired); return desired; }
+
+        T exchange(T desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return update([desired](T) { return desired; }, order);
+        }
+
+        bool compare_exchange_strong(T& expected, T desired,
+                                     std::memory_order order = std::memory_order_seq_cst) noexcept {
+            stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+            if (value.compare_exchange_strong(expected, desired, order)) return true;
+            stats->contended.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        bool compare_exchange_weak(T& expected, T desired,
+                                   std::memory_order order = std::memory_order_seq_cst) noexcept {
+            stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+            if (value.compare_exchange_weak(expected, desired, order)) return true;
+            stats->contended.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        T fetch_add(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return update([arg](T v) { return static_cast<T>(v + arg); }, order);
+        }
+        T fetch_sub(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return update([arg](T v) { return static_cast<T>(v - arg); }, order);
+        }
+        T fetch_and(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return update([arg](T v) { return static_cast<T>(v & arg); }, order);
+        }
+        T fetch_or(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return update([arg](T v) { return static_cast<T>(v | arg); }, order);
+        }
+        T fetch_xor(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return update([arg](T v) { return static_cast<T>(v ^ arg); }, order);
+        }
+
+        T operator++() noexcept { return static_cast<T>(fetch_add(1) + 1); }
+        T operator--() noexcept { return static_cast<T>(fetch_sub(1) - 1); }
+        T operator++(int) noexcept { return fetch_add(1); }
+        T operator--(int) noexcept { return fetch_sub(1); }
+        T operator+=(T arg) noexcept { return static_cast<T>(fetch_add(arg) + arg); }
+        T operator-=(T arg) noexcept { return static_cast<T>(fetch_sub(arg) - arg); }
+
+    private:
+        template<typename F>
+        T update(F f, std::memory_order order) noexcept {
+            stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+
+            auto old = value.load(std::memory_order_relaxed);
+            if (value.compare_exchange_strong(old, f(old), order, std::memory_order_relaxed)) return old;
+
+            auto start = nowNs();
+            while (!value.compare_exchange_weak(old, f(old), order, std::memory_order_relaxed)) {}
+            stats->contended.fetch_add(1, std::memory_order_relaxed);
+            stats->wait.record(nowNs() - start);
+            return old;
+        }
+
+        std::atomic<T> value;
+        Stats* stats;
+    };
+
+    inline void dumpJson(std::ostream& os) { Registry::instance().writeJson(os); }
+#else
+    constexpr bool enabled = false;
+
+    class InstrumentedMutex: public std::mutex {
+    public:
+        explicit InstrumentedMutex(const char*) noexcept {}
+    };
+
+    using ConditionVariable = std::condition_variable;
+    using MutexLock = std::unique_lock<std::mutex>;
+
+    template<typename T>
+    class InstrumentedAtomic: public std::atomic<T> {
+    public:
+        explicit InstrumentedAtomic(const char*, T desired = T()) noexcept : std::atomic<T>(desired) {}
+
+        using std::atomic<T>::operator=;
+    };
+
+    inline void dumpJson(std::ostream& os) { os << "{\"enabled\": false, \"objects\": []}\n"; }
+#endif
+}
+
 namespace item16 {
     class Polynomial {
     public:
         using RootsType = std::vector<double>;
+        using CoeffsType = std::vector<double>;     // constant term first
 
         RootsType roots() const {
-            std::lock_guard<std::mutex> g(m);
+            std::lock_guard<contention::InstrumentedMutex> g(m);
 
             if (!rootsAreValid) {
+                rootVals = computeRoots(coeffs);
                 rootsAreValid = true;
             }
             return rootVals;
         };
 
+        // roots() locks m on every call and copies rootVals, even once the roots
+        // are valid. For read-mostly callers, sharedRoots publishes the roots once
+        // as an immutable snapshot behind an atomically swapped std::shared_ptr:
+        // after the first call, readers take no lock and copy nothing (they share
+        // ownership of the snapshot instead).
+        using RootsPtr = std::shared_ptr<const RootsType>;
+
+        RootsPtr sharedRoots() const {
+            if (auto r = loadSnapshot()) return r;
+
+            std::lock_guard<contention::InstrumentedMutex> g(m);   // first call: one thread computes
+            if (auto r = loadSnapshot()) return r;
+
+            auto r = std::make_shared<const RootsType>(computeRoots(coeffs));
+            storeSnapshot(r);
+            return r;
+        }
+
+        // Writers are serialised by m, but never block readers: they publish a new
+        // snapshot, and readers still holding the old one keep it alive until
+        // they're done with it.
+        void setCoefficients(CoeffsType newCoeffs) {
+            auto r = std::make_shared<const RootsType>(computeRoots(newCoeffs));
+
+            std::lock_guard<contention::InstrumentedMutex> g(m);
+            coeffs = std::move(newCoeffs);
+            rootsAreValid = false;
+            storeSnapshot(std::move(r));
+        }
+
     private:
-        mutable std::mutex m;
+        // expensive computation (only real roots of linear and quadratic
+        // polynomials here)
+        static RootsType computeRoots(const CoeffsType& c) {
+            auto degree = c.size();
+            while (degree > 0 && c[degree - 1] == 0) --degree;
+
+            if (degree == 2) return { -c[0] / c[1] };
+            if (degree == 3) {
+                auto disc = c[1] * c[1] - 4 * c[2] * c[0];
+                if (disc < 0) return {};
+                auto sq = std::sqrt(disc);
+                RootsType r{ (-c[1] - sq) / (2 * c[2]), (-c[1] + sq) / (2 * c[2]) };
+                std::sort(r.begin(), r.end());
+                return r;
+            }
+            return {};
+        }
+
+#if defined(__cpp_lib_atomic_shared_ptr)
+        RootsPtr loadSnapshot() const { return snapshot.load(std::memory_order_acquire); }
+        void storeSnapshot(RootsPtr r) const { snapshot.store(std::move(r), std::memory_order_release); }
+
+        mutable std::atomic<RootsPtr> snapshot;
+#else
+        RootsPtr loadSnapshot() const { return std::atomic_load_explicit(&snapshot, std::memory_order_acquire); }
+        void storeSnapshot(RootsPtr r) const { std::atomic_store_explicit(&snapshot, std::move(r), std::memory_order_release); }
+
+        mutable RootsPtr snapshot;
+#endif
+
+        mutable contention::InstrumentedMutex m{ "item16::Polynomial::m" };
         mutable bool rootsAreValid { false };
         mutable RootsType rootVals{};
+        CoeffsType coeffs{};
+    };
+
+
+    // A single std::atomic bumped from many threads bounces its cache line
+    // between cores on every increment. ShardedCounter spreads the count over
+    // NumSlots cache-line-sized slots; each thread always increments the same
+    // slot (relaxed, since nothing else is published through the counter), and
+    // only a read has to visit them all.
+    template<std::size_t NumSlots = 16>
+    class ShardedCounter {
+    public:
+        static_assert(NumSlots != 0 && (NumSlots & (NumSlots - 1)) == 0,
+                      "NumSlots must be a power of two");
+
+        void increment(unsigned n = 1) noexcept {
+            slots[threadSlot() & (NumSlots - 1)].count.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        unsigned load() const noexcept {
+            unsigned total = 0;
+            for (auto& s : slots) total += s.count.load(std::memory_order_relaxed);
+            return total;
+        }
+
+    private:
+        struct alignas(64) Slot {
+            std::atomic<unsigned> count{ 0 };
+        };
+
+        static std::size_t threadSlot() noexcept {
+            static std::atomic<std::size_t> nextSlot{ 0 };
+            thread_local const std::size_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed);
+            return slot;
+        }
+
+        Slot slots[NumSlots];
     };
 
 
     class Point {
     public:
+        Point(double xVal = 0, double yVal = 0) noexcept: x(xVal), y(yVal) {}
+
+        double xValue() const noexcept { return x; }
+        double yValue() const noexcept { return y; }
+
         double distanceFromOrigin() const noexcept {
-            ++callCount;
+            callCount.increment();
             return std::sqrt((x * x) + (y * y));
         }
 
+        unsigned distanceCalls() const noexcept { return callCount.load(); }
+
     private:
-        mutable std::atomic<unsigned> callCount{0};
+        mutable ShardedCounter<8> callCount;     // 8 slots: a Point is 512 bytes
+                                                // bigger, in exchange for no sharing
         double x, y;
     };
 
+    // For bulk use, keep the coordinates as a structure of arrays: all xs, then
+    // all ys, so the distance computation streams through two dense arrays and
+    // works on several points per instruction. (The batch functions don't touch
+    // the Points' call counters.)
+    struct PointsSoA {
+        std::vector<double> xs;
+        std::vector<double> ys;
+
+        PointsSoA() = default;
+        PointsSoA(const Point* points, std::size_t n) {
+            xs.reserve(n);
+            ys.reserve(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                xs.push_back(points[i].xValue());
+                ys.push_back(points[i].yValue());
+            }
+        }
+
+        std::size_t size() const noexcept { return xs.size(); }
+    };
+
+    // out must have room for points.size() values
+    void distancesFromOrigin(const PointsSoA& points, double* out) noexcept {
+        const auto n = points.size();
+        const double* xs = points.xs.data();
+        const double* ys = points.ys.data();
+
+        std::size_t i = 0;
+#ifdef __SSE2__
+        // std::sqrt may set errno, which keeps compilers from vectorizing the
+        // loop below by themselves; SSE2 is baseline on x86-64
+        for (; i + 2 <= n; i += 2) {
+            auto vx = _mm_loadu_pd(xs + i);
+            auto vy = _mm_loadu_pd(ys + i);
+            auto sq = _mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy));
+            _mm_storeu_pd(out + i, _mm_sqrt_pd(sq));
+        }
+#endif
+        for (; i < n; ++i) {
+            out[i] = std::sqrt((xs[i] * xs[i]) + (ys[i] * ys[i]));
+        }
+    }
+
+    // Straight from an array of Points, without copying them into a PointsSoA
+    // first: a Point is too big for its coordinates to be loaded side by side,
+    // so each pair of points is packed into registers by hand. Call this when
+    // the points arrive as Points; keep a PointsSoA when they can be stored
+    // that way to begin with.
+    void distancesFromOrigin(const Point* points, std::size_t n, double* out) noexcept {
+        std::size_t i = 0;
+#ifdef __SSE2__
+        for (; i + 2 <= n; i += 2) {
+            auto vx = _mm_set_pd(points[i + 1].xValue(), points[i].xValue());
+            auto vy = _mm_set_pd(points[i + 1].yValue(), points[i].yValue());
+            auto sq = _mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy));
+            _mm_storeu_pd(out + i, _mm_sqrt_pd(sq));
+        }
+#endif
+        for (; i < n; ++i) {
+            const auto x = points[i].xValue();
+            const auto y = points[i].yValue();
+            out[i] = std::sqrt((x * x) + (y * y));
+        }
+    }
+
+    std::vector<double> distancesFromOrigin(const Point* points, std::size_t n) {
+        std::vector<double> out(n);
+        distancesFromOrigin(points, n, out.data());
+        return out;
+    }
+
     // For a single variable or memory location requiring sychronization,
     // use of a std::atmoic is adequate, but once you get to two or more
     // variables or memory locations that require manipulation as a unit,
     // you should reach for a mutex.
+    //
+    // Once the value is cached, though, there's nothing left to manipulate as a
+    // unit, so a hit needn't lock anything. LazyCached computes a value at most
+    // once: a hit is a single acquire load of the valid flag, and only a miss
+    // takes the mutex (double-checked, so the computation runs just once). The
+    // release store of valid happens after cachedValue is written, so a reader
+    // that sees valid == true also sees the value.
+    //
+    // The counters track the slow path only (a shared hit counter would make
+    // the hit path contend on its cache line): how often the mutex had to be
+    // locked, how often it was already held, and how long threads waited for it.
+    template<typename T>
+    class LazyCached {
+    public:
+        struct Stats {
+            std::uint64_t lockAcquisitions;
+            std::uint64_t contendedAcquisitions;
+            std::chrono::nanoseconds waitTime;
+        };
+
+        template<typename F>
+        const T& get(F&& compute) const {
+            if (valid.load(std::memory_order_acquire)) return *cachedValue;
+
+            std::unique_lock<contention::InstrumentedMutex> guard(m, std::try_to_lock);
+            if (!guard.owns_lock()) {
+                auto start = std::chrono::steady_clock::now();
+                guard.lock();
+                auto waited = std::chrono::steady_clock::now() - start;
+                contended.fetch_add(1, std::memory_order_relaxed);
+                waitNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count(),
+                                    std::memory_order_relaxed);
+            }
+            acquisitions.fetch_add(1, std::memory_order_relaxed);
+
+            if (!valid.load(std::memory_order_relaxed)) {   // still a miss?
+                cachedValue.emplace(std::forward<F>(compute)());
+                valid.store(true, std::memory_order_release);
+            }
+            return *cachedValue;
+        }
+
+        Stats stats() const noexcept {
+            return { acquisitions.load(std::memory_order_relaxed),
+                     contended.load(std::memory_order_relaxed),
+                     std::chrono::nanoseconds(waitNanos.load(std::memory_order_relaxed)) };
+        }
+
+    private:
+        mutable contention::InstrumentedMutex m{ "item16::LazyCached::m" };
+        mutable std::atomic<bool> valid { false };
+        mutable std::optional<T> cachedValue;
+
+        mutable std::atomic<std::uint64_t> acquisitions { 0 };
+        mutable std::atomic<std::uint64_t> contended { 0 };
+        mutable std::atomic<std::int64_t> waitNanos { 0 };
+    };
+
     class Widget {
     public:
         int magicValue() const {
-            std::lock_guard<std::mutex> guard(m); // lock m
-
-            if (cacheValid) return cacheValid;
-            else {
+            return cache.get([] {
                 auto val1 = 1; // expensive computation
                 auto val2 = 2;
-                cacheValid = val1 + val2;
-                cacheValid = true;
-                return cachedValue;
-            }
+                return val1 + val2;
+            });
         }
+
+        LazyCached<int>::Stats magicValueStats() const noexcept { return cache.stats(); }
     private:
-        mutable std::mutex m;
-        mutable std::atomic<bool> cacheValid { false };
-        mutable std::atomic<int> cachedValue;
+        LazyCached<int> cache;
     };
 }
 
 int main() {
     using namespace item16;
 
+    Polynomial p;
+    p.setCoefficients({ -2, 0, 1 });        // x^2 - 2
+
+    auto r = p.sharedRoots();               // computed once, shared from then on
+    std::cout << "roots: " << r->front() << ", " << r->back() << '\n';
+
+    Widget w;
+    std::cout << "magic value: " << w.magicValue() << '\n';
+    std::cout << "locked " << w.magicValueStats().lockAcquisitions << " time(s)" << '\n';
+
+    const Point points[] = { { 0, 0 }, { 3, 4 }, { 6, 8 }, { 9, 12 }, { 12, 16 } };
+
+    for (auto d : distancesFromOrigin(points, std::size(points))) std::cout << d << ' ';
+    std::cout << '\n';
+
+    // readers and a writer fighting over p's mutex; build with
+    // -DITEM16_INSTRUMENT_LOCKS to see how much it hurt
+    {
+        std::vector<std::thread> threads;
+        for (auto t = 0; t < 4; ++t) {
+            threads.emplace_back([&p, t] {
+                for (auto i = 0; i < 20'000; ++i) {
+                    if (t == 0 && i % 100 == 0) p.setCoefficients({ -2.0 - i, 0, 1 });
+                    else p.roots();
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+    }
+    contention::dumpJson(std::cout);
+
 
 
 
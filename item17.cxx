@@ -1,8 +1,12 @@
 #include <iostream>
+#include <array>
 #include <atomic>
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdlib>
 #include <memory>   // include std::unique_ptr
+#include <new>
 #include <vector>
 #include <mutex>
 #include <unordered_map>
@@ -30,6 +34,162 @@
  *  # Member function templates never suppress generation of special member functions
  * */
 
+// Counting instrumentation for the items whose advice is about how many
+// allocations, copies and moves happen (17, 22, 41, 42). Every dynamic
+// allocation in the program goes through the replacement global operator new
+// and delete below, which count them; an AllocationScope reports what has
+// happened since it was created. CountingType counts calls of its own special
+// member functions the same way (a CountingScope reads them), and prints each
+// one while CountingType::log is set. expect() checks a count against the
+// number the item predicts; main's exit status is whether they all held.
+namespace accounting {
+    std::atomic<std::size_t> allocations{ 0 };
+    std::atomic<std::size_t> deallocations{ 0 };
+    std::atomic<std::size_t> bytesAllocated{ 0 };
+
+    struct AllocationCounts {
+        std::size_t allocations;
+        std::size_t deallocations;
+        std::size_t bytes;
+    };
+
+    AllocationCounts allocationTotals() noexcept {
+        return { allocations.load(std::memory_order_relaxed),
+                 deallocations.load(std::memory_order_relaxed),
+                 bytesAllocated.load(std::memory_order_relaxed) };
+    }
+
+    class AllocationScope {
+    public:
+        AllocationScope() noexcept : start(allocationTotals()) {}
+
+        AllocationCounts counts() const noexcept {
+            auto now = allocationTotals();
+            return { now.allocations - start.allocations,
+                     now.deallocations - start.deallocations,
+                     now.bytes - start.bytes };
+        }
+
+        std::size_t allocations() const noexcept { return counts().allocations; }
+        std::size_t deallocations() const noexcept { return counts().deallocations; }
+
+    private:
+        AllocationCounts start;
+    };
+
+    struct SpecialMemberCounts {
+        std::size_t constructs;         // from a value, or by default
+        std::size_t copyConstructs;
+        std::size_t moveConstructs;
+        std::size_t copyAssigns;
+        std::size_t moveAssigns;
+        std::size_t destructs;
+    };
+
+    // The counts are plain integers, so only one thread at a time should be
+    // using CountingTypes. The converting constructor is implicit so that a
+    // CountingType can stand in for an element type built from a different
+    // argument type (Item 42's std::string from a const char*).
+    class CountingType {
+    public:
+        CountingType() noexcept : CountingType(0) {}
+        CountingType(int value) noexcept : value(value) { note(counts.constructs, "constructed"); }
+
+        CountingType(const CountingType& rhs) noexcept : value(rhs.value) {
+            note(counts.copyConstructs, "copy constructed");
+        }
+        CountingType(CountingType&& rhs) noexcept : value(rhs.value) {
+            note(counts.moveConstructs, "move constructed");
+        }
+
+        CountingType& operator=(const CountingType& rhs) noexcept {
+            value = rhs.value;
+            note(counts.copyAssigns, "copy assigned");
+            return *this;
+        }
+        CountingType& operator=(CountingType&& rhs) noexcept {
+            value = rhs.value;
+            note(counts.moveAssigns, "move assigned");
+            return *this;
+        }
+
+        ~CountingType() { note(counts.destructs, "destroyed"); }
+
+        friend bool operator<(const CountingType& lhs, const CountingType& rhs) noexcept {
+            return lhs.value < rhs.value;
+        }
+
+        int value;
+
+        static SpecialMemberCounts counts;
+        static bool log;
+
+    private:
+        void note(std::size_t& count, const char* what) const noexcept {
+            ++count;
+            if (log) std::cout << "    CountingType(" << value << ") " << what << '\n';
+        }
+    };
+
+    SpecialMemberCounts CountingType::counts{};
+    bool CountingType::log = false;
+
+    class CountingScope {
+    public:
+        CountingScope() noexcept : start(CountingType::counts) {}
+
+        SpecialMemberCounts counts() const noexcept {
+            auto& now = CountingType::counts;
+            return { now.constructs - start.constructs,
+                     now.copyConstructs - start.copyConstructs,
+                     now.moveConstructs - start.moveConstructs,
+                     now.copyAssigns - start.copyAssigns,
+                     now.moveAssigns - start.moveAssigns,
+                     now.destructs - start.destructs };
+        }
+
+    private:
+        SpecialMemberCounts start;
+    };
+
+    int failureCount = 0;
+
+    bool expect(const char* what, std::size_t actual, std::size_t expected) {
+        const bool held = actual == expected;
+        if (!held) ++failureCount;
+
+        std::cout << (held ? "  ok    " : "  FAIL  ") << what << ": " << actual;
+        if (!held) std::cout << " (expected " << expected << ")";
+        std::cout << '\n';
+        return held;
+    }
+
+    int failures() noexcept { return failureCount; }
+}
+
+void* operator new(std::size_t size) {
+    accounting::allocations.fetch_add(1, std::memory_order_relaxed);
+    accounting::bytesAllocated.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+// GCC pairs the std::free here with the std::malloc in operator new only while
+// operator delete does nothing else, and otherwise flags every inlined
+// deallocation as mismatched
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+    if (p) accounting::deallocations.fetch_add(1, std::memory_order_relaxed);
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept { ::operator delete(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
 
 namespace item7 {
     int x(0);  // initializer in parentheses
@@ -482,13 +642,63 @@ namespace item17 {
     //
 
 
+    // The rules above, counted: each class holds a CountingType, so moving
+    // one shows whether the member was moved or copied.
+    struct Implicit {                   // all special members generated
+        accounting::CountingType c;
+    };
+
+    struct WithDestructor {             // a user-declared destructor: no moves
+        accounting::CountingType c;     // generated, so "moving" copies
+        ~WithDestructor() {}
+    };
+
+    struct WithDefaultedMoves {         // the fix: declare them "= default"
+        accounting::CountingType c;
+        WithDefaultedMoves() = default;
+        ~WithDefaultedMoves() {}
+        WithDefaultedMoves(WithDefaultedMoves&&) = default;
+        WithDefaultedMoves& operator=(WithDefaultedMoves&&) = default;
+        WithDefaultedMoves(const WithDefaultedMoves&) = default;
+        WithDefaultedMoves& operator=(const WithDefaultedMoves&) = default;
+    };
+
+    struct WithTemplates {              // member templates don't suppress
+        accounting::CountingType c;     // the generated copies and moves
+        WithTemplates() = default;
+        template<typename T> WithTemplates(const T&) {}
+        template<typename T> WithTemplates& operator=(const T&) { return *this; }
+    };
+
+    template<typename T>
+    void checkMoves(const char* label, std::size_t moves, std::size_t copies) {
+        T source;
+        T target;
+
+        accounting::CountingScope scope;
+        T constructed(std::move(source));
+        target = std::move(constructed);
+        auto counts = scope.counts();
+
+        std::cout << label << '\n';
+        accounting::expect("moves (construct, assign)", counts.moveConstructs + counts.moveAssigns, moves);
+        accounting::expect("copies (construct, assign)", counts.copyConstructs + counts.copyAssigns, copies);
+    }
+
+    void checkCounts() {
+        checkMoves<Implicit>("implicit special members", 2, 0);
+        checkMoves<WithDestructor>("user-declared destructor", 0, 2);
+        checkMoves<WithDefaultedMoves>("destructor and defaulted moves", 2, 0);
+        checkMoves<WithTemplates>("member function templates", 2, 0);
+    }
+
 }
 
 int main() {
     using namespace item16;
 
+    item17::checkCounts();
 
 
-
-    return 0;
+    return accounting::failures() == 0 ? 0 : 1;
 }
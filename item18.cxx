@@ -1,5 +1,20 @@
 #include <iostream>
 #include <memory>   // include std::unique_ptr
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
+#include <variant>
+#include <vector>
 
 
 
@@ -26,33 +41,257 @@ namespace item18 {
     class Investment {
     public:
         virtual ~Investment();
+
+        virtual double value() const = 0;
     };
 
+    Investment::~Investment() = default;
+
     class Stock: public Investment {
+    public:
+        Stock(double shares = 0, double price = 0): shares(shares), price(price) {}
 
+        double value() const override { return shares * price; }
+    private:
+        double shares, price;
     };
 
     class Bond: public Investment {
+    public:
+        Bond(double faceValue = 0, double pricePct = 100): faceValue(faceValue), pricePct(pricePct) {}
 
+        double value() const override { return faceValue * pricePct / 100; }
+    private:
+        double faceValue, pricePct;     // price quoted as a percentage of face value
     };
 
     class RealEstate: public Investment {
+    public:
+        RealEstate(double area = 0, double pricePerSqm = 0, double vacancy = 0)
+        : area(area), pricePerSqm(pricePerSqm), vacancy(vacancy) {}
+
+        double value() const override { return area * pricePerSqm * (1 - vacancy); }
+    private:
+        double area, pricePerSqm, vacancy;
+    };
+
+    // Logging each destruction mustn't cost the deleter a write to a file. The
+    // deleter only records what happened in a compact binary record and hands
+    // it to a background thread, which formats and writes records in batches.
+    struct LogRecord {
+        std::uint64_t timestampNs;          // steady_clock, since the sink started
+        const void* address;                // the object being destroyed
+        const std::type_info* type;         // its dynamic type
+    };
+
+    // Bounded multi-producer, single-consumer ring. Each cell carries a
+    // sequence number telling producers whether it's free and the consumer
+    // whether it's filled, so a producer claims a cell with one CAS on
+    // enqueuePos and never waits for anyone. A full ring drops the record
+    // (and counts it) rather than make the deleter block.
+    template<std::size_t Capacity>
+    class MPSCRing {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                      "Capacity must be a power of two");
+    public:
+        MPSCRing() {
+            for (std::size_t i = 0; i < Capacity; ++i)
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
 
+        bool tryPush(const LogRecord& record) noexcept {
+            auto pos = enqueuePos.load(std::memory_order_relaxed);
+            for (;;) {
+                auto& cell = cells[pos & (Capacity - 1)];
+                auto seq = cell.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+                if (diff == 0) {            // free: try to claim it
+                    if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.record = record;
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0) {        // still holds a record from a lap ago
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                else {                      // another producer got there first
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // only ever called from the consumer thread
+        bool tryPop(LogRecord& record) noexcept {
+            auto& cell = cells[dequeuePos & (Capacity - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1) return false;
+
+            record = cell.record;
+            cell.sequence.store(dequeuePos + Capacity, std::memory_order_release);
+            ++dequeuePos;
+            return true;
+        }
+
+        // also only from the consumer: whether tryPop would succeed
+        bool readable() const noexcept {
+            return cells[dequeuePos & (Capacity - 1)].sequence.load(std::memory_order_acquire) == dequeuePos + 1;
+        }
+
+        std::size_t takeDropped() noexcept { return dropped.exchange(0, std::memory_order_relaxed); }
+
+    private:
+        struct Cell {
+            std::atomic<std::size_t> sequence;
+            LogRecord record;
+        };
+
+        alignas(64) std::atomic<std::size_t> enqueuePos{ 0 };
+        alignas(64) std::size_t dequeuePos = 0;
+        std::atomic<std::size_t> dropped{ 0 };
+        alignas(64) Cell cells[Capacity];
     };
 
+    class AsyncLogSink;
+
+    // where makeLogEntry sends records: nowhere until openLogSink runs
+    std::atomic<AsyncLogSink*> currentSink{ nullptr };
+
+    // The flusher sleeps on a condition variable while the ring is empty. The
+    // deleters don't signal it for every record, only once it has said it's
+    // going to sleep; a fence on either side keeps a record pushed just as the
+    // flusher checks the ring from slipping between the two.
+    class AsyncLogSink {
+    public:
+        static constexpr std::size_t capacity = 1 << 14;
+
+        // with no path, records are still collected, then discarded
+        explicit AsyncLogSink(const char* path)
+        : start(std::chrono::steady_clock::now()) {
+            if (path) {
+                out.open(path, std::ios::out | std::ios::trunc);    // one run's log, not every run's
+                if (!out) throw std::runtime_error(std::string("can't open ") + path);
+            }
+            flusher = std::thread(&AsyncLogSink::flushLoop, this);
+        }
+
+        // drains whatever producers have managed to enqueue before returning
+        ~AsyncLogSink() {
+            auto self = this;
+            currentSink.compare_exchange_strong(self, nullptr, std::memory_order_acq_rel);
+            running.store(false, std::memory_order_release);
+            wake();
+            flusher.join();
+        }
+
+        AsyncLogSink(const AsyncLogSink&) = delete;
+        AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+
+        void log(const void* address, const std::type_info& type) noexcept {
+            auto now = std::chrono::steady_clock::now() - start;
+            ring.tryPush({ static_cast<std::uint64_t>(
+                               std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()),
+                           address, &type });
+
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping.load(std::memory_order_relaxed)) wake();
+        }
+
+    private:
+        void wake() noexcept {
+            { std::lock_guard<std::mutex> g(m); }   // the flusher is either still checking,
+            cv.notify_one();                        // or already waiting for this
+        }
+
+        void flushLoop() {
+            std::string batch;
+            for (;;) {
+                bool stopping = !running.load(std::memory_order_acquire);
+                if (drain(batch) == 0) {
+                    if (stopping) break;    // producers are done and the ring is empty
+
+                    std::unique_lock<std::mutex> g(m);
+                    sleeping.store(true, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    cv.wait(g, [this] {
+                        return ring.readable() || !running.load(std::memory_order_acquire);
+                    });
+                    sleeping.store(false, std::memory_order_relaxed);
+                }
+            }
+            out.flush();
+        }
+
+        std::size_t drain(std::string& batch) {
+            batch.clear();
+            std::size_t n = 0;
+            LogRecord r;
+            if (!out.is_open()) {           // nothing to write to
+                while (ring.tryPop(r)) ++n;
+                ring.takeDropped();
+                return n;
+            }
+            while (n < capacity && ring.tryPop(r)) {
+                batch += std::to_string(r.timestampNs);
+                batch += "ns destroyed ";
+                batch += r.type->name();
+                batch += " at ";
+                batch += std::to_string(reinterpret_cast<std::uintptr_t>(r.address));
+                batch += '\n';
+                ++n;
+            }
+            if (auto lost = ring.takeDropped()) {
+                batch += std::to_string(lost) + " records dropped: log ring full\n";
+            }
+            if (!batch.empty()) out.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+            return n;
+        }
+
+        MPSCRing<capacity> ring;
+        std::ofstream out;
+        std::chrono::steady_clock::time_point start;
+        std::atomic<bool> running{ true };
+        std::atomic<bool> sleeping{ false };
+        std::mutex m;
+        std::condition_variable cv;
+        std::thread flusher;                // started last, once the rest exists
+    };
+
+    // The sink is created up front, not on the first destruction: opening its
+    // file or starting its thread may throw, and the deleter runs inside
+    // unique_ptr's noexcept destructor. The first call's path wins; the sink
+    // lives until the program ends, so shared_ptrs released late still log.
+    AsyncLogSink& openLogSink(const char* path) {
+        static AsyncLogSink sink(path);
+        currentSink.store(&sink, std::memory_order_release);
+        return sink;
+    }
+
+    // typeid on the pointee is a vptr load; no formatting happens here
+    void makeLogEntry(const Investment* pInvestment) noexcept {
+        if (auto sink = currentSink.load(std::memory_order_acquire)) sink->log(pInvestment, typeid(*pInvestment));
+    }
+
     // custom deleter as stateless lambda
     auto delInvmt = [](Investment* pInvestment) {
-        // makeLogEntry(pInvestment);
+        makeLogEntry(pInvestment);
         delete pInvestment;
     };
 
     // custom deleter as function
     // return type has size of Investment* plus at least size of function pointer!
     void delInvmt2(Investment* pInvestment) {
-        // makeLogEntry(pInvestment);
+        makeLogEntry(pInvestment);
         delete pInvestment;
     }
 
+    // the logging deleter costs the std::unique_ptr nothing in size
+    static_assert(sizeof(std::unique_ptr<Investment, decltype(delInvmt)>) == sizeof(Investment*),
+                  "stateless deleter must not grow std::unique_ptr");
+    static_assert(sizeof(std::unique_ptr<Investment, void (*)(Investment*)>) > sizeof(Investment*),
+                  "function pointer deleter is stored in the std::unique_ptr");
+
     template<typename... Ts>
     //std::unique_ptr<Investment, decltype(delInvmt)>
     auto makeInvestment(Ts&&... params) {
@@ -71,17 +310,201 @@ namespace item18 {
         return pInv;
     }
 
+    // Walking millions of Investments through std::unique_ptr costs a pointer
+    // chase and an indirect call apiece. When the set of types is closed, a
+    // value-semantic alternative does without both: the value types carry just
+    // their data, a std::variant holds any one of them, and a Portfolio keeps
+    // each type's fields in columns of their own (structure of arrays) so a
+    // valuation is three straight loops over contiguous doubles.
+    // makeInvestment above remains the polymorphic path.
+    namespace values {
+        struct Stock { double shares, price; };
+        struct Bond { double faceValue, pricePct; };
+        struct RealEstate { double area, pricePerSqm, vacancy; };
+
+        inline double value(const Stock& s) { return s.shares * s.price; }
+        inline double value(const Bond& b) { return b.faceValue * b.pricePct / 100; }
+        inline double value(const RealEstate& r) { return r.area * r.pricePerSqm * (1 - r.vacancy); }
+    }
+
+    using InvestmentValue = std::variant<values::Stock, values::Bond, values::RealEstate>;
+
+    inline double value(const InvestmentValue& investment) {
+        return std::visit([](const auto& i) { return values::value(i); }, investment);
+    }
+
+    class Portfolio {
+    public:
+        struct Stocks { std::vector<double> shares, price; };
+        struct Bonds { std::vector<double> faceValue, pricePct; };
+        struct RealEstates { std::vector<double> area, pricePerSqm, vacancy; };
+
+        void add(const InvestmentValue& investment) {
+            std::visit([this](const auto& i) { append(i); }, investment);
+        }
+
+        std::size_t size() const {
+            return stocks.shares.size() + bonds.faceValue.size() + realEstates.area.size();
+        }
+
+        // Hands f each type's columns in turn, so callers write one batch
+        // kernel per type, just as they'd write one std::visit overload.
+        template<typename F>
+        void visitBatches(F&& f) const {
+            f(stocks);
+            f(bonds);
+            f(realEstates);
+        }
+
+        double totalValue() const {
+            double total = 0;
+            visitBatches([&total](const auto& batch) { total += batchValue(batch); });
+            return total;
+        }
+
+    private:
+        void append(const values::Stock& s) {
+            stocks.shares.push_back(s.shares);
+            stocks.price.push_back(s.price);
+        }
+        void append(const values::Bond& b) {
+            bonds.faceValue.push_back(b.faceValue);
+            bonds.pricePct.push_back(b.pricePct);
+        }
+        void append(const values::RealEstate& r) {
+            realEstates.area.push_back(r.area);
+            realEstates.pricePerSqm.push_back(r.pricePerSqm);
+            realEstates.vacancy.push_back(r.vacancy);
+        }
+
+        static double batchValue(const Stocks& s) {
+            double total = 0;
+            for (std::size_t i = 0; i < s.shares.size(); ++i) total += s.shares[i] * s.price[i];
+            return total;
+        }
+        static double batchValue(const Bonds& b) {
+            double total = 0;
+            for (std::size_t i = 0; i < b.faceValue.size(); ++i) total += b.faceValue[i] * b.pricePct[i];
+            return total / 100;
+        }
+        static double batchValue(const RealEstates& r) {
+            double total = 0;
+            for (std::size_t i = 0; i < r.area.size(); ++i)
+                total += r.area[i] * r.pricePerSqm[i] * (1 - r.vacancy[i]);
+            return total;
+        }
+
+        Stocks stocks;
+        Bonds bonds;
+        RealEstates realEstates;
+    };
+
+    // Values a portfolio of n randomly interleaved investments three ways:
+    // polymorphic objects behind std::unique_ptr, a std::vector of variants
+    // walked with std::visit, and the SoA Portfolio. Each representation
+    // is built, timed and freed before the next, to keep the peak footprint
+    // to one of them.
+    void benchmarkValuation(std::size_t n) {
+        using Clock = std::chrono::steady_clock;
+
+        auto makeValue = [state = std::uint64_t{ 42 }]() mutable -> InvestmentValue {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            auto r = static_cast<double>(state >> 40) / (1 << 24);     // [0, 1)
+            switch ((state >> 33) % 3) {
+            case 0:  return values::Stock{ 1 + r * 100, 10 + r * 50 };
+            case 1:  return values::Bond{ 1000, 95 + r * 10 };
+            default: return values::RealEstate{ 50 + r * 200, 3000, r * 0.2 };
+            }
+        };
+        auto report = [](const char* label, Clock::duration elapsed, std::size_t n, double total) {
+            std::cout << "  " << label << ": "
+                      << std::chrono::duration<double, std::nano>(elapsed).count() / n
+                      << " ns per investment (total " << total << ")" << '\n';
+        };
+
+        std::cout << "valuing " << n << " investments" << '\n';
+        {
+            std::vector<std::unique_ptr<Investment>> investments;
+            investments.reserve(n);
+            auto make = makeValue;
+            for (std::size_t i = 0; i < n; ++i) {
+                investments.push_back(std::visit([](const auto& v) -> std::unique_ptr<Investment> {
+                    using T = std::decay_t<decltype(v)>;
+                    if constexpr (std::is_same_v<T, values::Stock>)
+                        return std::make_unique<Stock>(v.shares, v.price);
+                    else if constexpr (std::is_same_v<T, values::Bond>)
+                        return std::make_unique<Bond>(v.faceValue, v.pricePct);
+                    else
+                        return std::make_unique<RealEstate>(v.area, v.pricePerSqm, v.vacancy);
+                }, make()));
+            }
+
+            auto start = Clock::now();
+            double total = 0;
+            for (const auto& p : investments) total += p->value();
+            report("virtual via unique_ptr", Clock::now() - start, n, total);
+        }
+        {
+            std::vector<InvestmentValue> investments;
+            investments.reserve(n);
+            auto make = makeValue;
+            for (std::size_t i = 0; i < n; ++i) investments.push_back(make());
+
+            auto start = Clock::now();
+            double total = 0;
+            for (const auto& v : investments) total += value(v);
+            report("std::visit over variants", Clock::now() - start, n, total);
+        }
+        {
+            Portfolio portfolio;
+            auto make = makeValue;
+            for (std::size_t i = 0; i < n; ++i) portfolio.add(make());
+
+            auto start = Clock::now();
+            auto total = portfolio.totalValue();
+            report("SoA Portfolio batches", Clock::now() - start, n, total);
+        }
+    }
+
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
     using namespace item18;
 
+    // the destruction log is written only on request: item18 --log <file>
+    const char* logPath = argc > 2 && std::strcmp(argv[1], "--log") == 0 ? argv[2] : nullptr;
+    try {
+        openLogSink(logPath);
+    } catch (const std::exception& e) {
+        std::cerr << "no destruction log: " << e.what() << '\n';
+        return 1;
+    }
+
     {
         auto pInvestment = makeInvestment(); // pInvestment is of type std::unique_ptr<Investment>
     }   // destroy *pInvestment
 
     std::shared_ptr<Investment> sp = makeInvestment(); // converts std::unique_ptr to std::shared_ptr
 
+    // what a logged destruction costs the thread doing it
+    {
+        constexpr auto n = 10'000;          // fits in the ring, so nothing is dropped
+
+        std::vector<std::unique_ptr<Investment, decltype(delInvmt)>> investments;
+        investments.reserve(n);
+        for (auto i = 0; i < n; ++i) investments.push_back(makeInvestment());
+
+        auto start = std::chrono::steady_clock::now();
+        investments.clear();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "logged destruction: "
+                  << std::chrono::duration<double, std::nano>(elapsed).count() / n
+                  << " ns per Investment" << '\n';
+    }
+
+    benchmarkValuation(10'000'000);
+
     return 0;
 }
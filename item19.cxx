@@ -1,6 +1,14 @@
 #include <iostream>
 #include <memory>   // include std::unique_ptr
 #include <vector>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 
 
@@ -87,34 +95,170 @@ namespace item19 {
     // 2. Memory for the reference count must be dynamically allocated.
     // 3. Increments and decrements of the reference count must be atomic.
 
+    // Memory for the reference count has to come from somewhere, and with
+    // std::shared_ptr<T>(new T, deleter) that's a second trip to the heap
+    // after the one for the T. A fixed-size block pool makes both trips cheap:
+    // blocks of one size and alignment are carved out of larger chunks and
+    // recycled through a free list, so steady-state churn never reaches
+    // operator new.
+    template<std::size_t Size, std::size_t Align>
+    class BlockPool {
+    public:
+        static BlockPool& instance() {
+            static BlockPool* pool = new BlockPool;     // never destroyed: shared_ptrs
+            return *pool;                               // in globals (processWidgets)
+                                                        // may release into it after main
+        }
+
+        void* allocate() {
+            std::lock_guard<std::mutex> lock(m);
+            if (!freeList) refill();
+            auto block = freeList;
+            freeList = freeList->next;
+            ++blocksInUse;
+            return block;
+        }
+
+        void deallocate(void* p) noexcept {
+            std::lock_guard<std::mutex> lock(m);
+            auto block = static_cast<Block*>(p);
+            block->next = freeList;
+            freeList = block;
+            --blocksInUse;
+        }
+
+        std::size_t inUse() const {
+            std::lock_guard<std::mutex> lock(m);
+            return blocksInUse;
+        }
+
+        BlockPool(const BlockPool&) = delete;
+        BlockPool& operator=(const BlockPool&) = delete;
+
+        // no destructor: the only pool is instance()'s, which is never
+        // destroyed, so its chunks go back to the system with the process
+
+    private:
+        BlockPool() = default;
+
+        struct Block { Block* next; };
+
+        static constexpr std::size_t chunkAlign = Align > alignof(Block) ? Align : alignof(Block);
+        static constexpr std::size_t blockSize =
+            ((Size > sizeof(Block) ? Size : sizeof(Block)) + chunkAlign - 1) / chunkAlign * chunkAlign;
+        static constexpr std::size_t blocksPerChunk = 64;
+
+        // the first block of every chunk links the chunks together, so they
+        // stay reachable from the pool (and a leak checker doesn't report them)
+        void refill() {
+            auto raw = static_cast<unsigned char*>(
+                ::operator new(blockSize * (blocksPerChunk + 1), std::align_val_t(chunkAlign)));
+            auto chunk = reinterpret_cast<Block*>(raw);
+            chunk->next = chunks;
+            chunks = chunk;
+
+            for (auto i = blocksPerChunk; i > 0; --i) {
+                auto block = reinterpret_cast<Block*>(raw + i * blockSize);
+                block->next = freeList;
+                freeList = block;
+            }
+        }
+
+        mutable std::mutex m;
+        Block* freeList = nullptr;
+        Block* chunks = nullptr;
+        std::size_t blocksInUse = 0;
+    };
+
+    // Allocator handing out single objects from the BlockPool for its value
+    // type. std::allocate_shared rebinds it to the type that holds the control
+    // block and the object together, so both live in one pooled block. Arrays
+    // (n > 1) aren't what the pool is for and go to operator new.
+    template<typename T>
+    class PoolAllocator {
+    public:
+        using value_type = T;
+
+        PoolAllocator() noexcept = default;
+        template<typename U>
+        PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+        T* allocate(std::size_t n) {
+            if (n == 1) return static_cast<T*>(pool().allocate());
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept {
+            if (n == 1) pool().deallocate(p);
+            else ::operator delete(p, std::align_val_t(alignof(T)));
+        }
+
+        static BlockPool<sizeof(T), alignof(T)>& pool() {
+            return BlockPool<sizeof(T), alignof(T)>::instance();
+        }
+
+        template<typename U>
+        bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+        template<typename U>
+        bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+    };
+
+    // new and delete for objects that are to live in the pool; the deleters
+    // below pair poolDelete with poolNew the way they'd pair delete with new
+    template<typename T, typename... Ts>
+    T* poolNew(Ts&&... params) {
+        PoolAllocator<T> alloc;
+        auto p = alloc.allocate(1);
+        try {
+            return ::new (static_cast<void*>(p)) T(std::forward<Ts>(params)...);
+        }
+        catch (...) {
+            alloc.deallocate(p, 1);
+            throw;
+        }
+    }
+
+    template<typename T>
+    void poolDelete(T* p) noexcept {
+        if (!p) return;
+        p->~T();
+        PoolAllocator<T>().deallocate(p, 1);
+    }
+
     // custom deleters
     class Widget: public std::enable_shared_from_this<Widget> {
     public:
         void process();
 
-        // factory function that perfect-forward args
-        // to a private ctor
+        // factory function that perfect-forwards args to a Widget ctor;
+        // object and control block come from the pool in a single block
         template<typename... Ts>
-        static std::shared_ptr<Widget> create(Ts&&... ) { return std::make_shared<Widget>(new Widget);  }
+        static std::shared_ptr<Widget> create(Ts&&... params) {
+            return std::allocate_shared<Widget>(PoolAllocator<Widget>(), std::forward<Ts>(params)...);
+        }
     private:
     };
 
     auto loggingDel = [](Widget *pw) {
         // makeLogEntry(pw);
-        delete pw;
+        poolDelete(pw);
     };
 
     std::unique_ptr<Widget, decltype(loggingDel)>   // deleter type is part
-        upw(new Widget, loggingDel);                // of ptr type
+        upw(poolNew<Widget>(), loggingDel);         // of ptr type
 
     std::shared_ptr<Widget>                         // deleter type is not
-        spw(new Widget, loggingDel);                // part of ptr type
+        spw(poolNew<Widget>(), loggingDel,          // part of ptr type; the
+            PoolAllocator<Widget>());               // allocator places the
+                                                    // control block
 
-    auto customDeleter1 = [](Widget* pw) { delete pw; };    // custom deleters each
-    auto customDeleter2 = [](Widget* pw) { delete pw; };    // with a different type
+    auto customDeleter1 = [](Widget* pw) { poolDelete(pw); };   // custom deleters each
+    auto customDeleter2 = [](Widget* pw) { poolDelete(pw); };   // with a different type
 
-    std::shared_ptr<Widget> pw1(new Widget, customDeleter1);
-    std::shared_ptr<Widget> pw2(new Widget, customDeleter2);
+    // A custom deleter rules out allocate_shared, so object and control block
+    // are still separate, but both come from the pool rather than the heap.
+    std::shared_ptr<Widget> pw1(poolNew<Widget>(), customDeleter1, PoolAllocator<Widget>());
+    std::shared_ptr<Widget> pw2(poolNew<Widget>(), customDeleter2, PoolAllocator<Widget>());
     // Because pw1 and pw2 have the same type, they can be placed in a cotainer of
     // that type, and aloso could pass to a function taking a parameter of type
     // std::shared_ptr<Widget>. None of these things can be down with std::unique_ptrs
@@ -164,7 +308,153 @@ namespace item19 {
     //    any necessary control blocks.
 
 
-    std::vector<std::shared_ptr<Widget>> processWidgets;
+    // process() is called from every worker, so processWidgets can't be a
+    // plain std::vector: pushes would race, and growing would move elements
+    // out from under anyone looking at them. AppendOnlyRegistry grows in
+    // segments instead, each twice the size of the one before, so elements
+    // never move. push_back claims an index with one fetch_add and installs a
+    // missing segment with a compare-exchange; no thread ever waits for
+    // another. Each element is marked ready once it's constructed, and
+    // readers see the longest prefix of ready elements, which never shrinks.
+    //
+    // clear and the destructor need every pusher to have finished.
+    template<typename T, std::size_t FirstSegmentBits = 6>
+    class AppendOnlyRegistry {
+    public:
+        AppendOnlyRegistry() = default;
+        AppendOnlyRegistry(const AppendOnlyRegistry&) = delete;
+        AppendOnlyRegistry& operator=(const AppendOnlyRegistry&) = delete;
+
+        ~AppendOnlyRegistry() { clear(); }
+
+        template<typename... Ts>
+        T& emplace_back(Ts&&... params) {
+            auto i = claimed.fetch_add(1, std::memory_order_relaxed);
+            return construct(i, std::forward<Ts>(params)...);
+        }
+
+        void push_back(const T& x) { emplace_back(x); }
+        void push_back(T&& x) { emplace_back(std::move(x)); }
+
+        // moves [first, last) in, claiming all of their indices at once
+        template<typename It>
+        void appendMoved(It first, It last) {
+            auto n = static_cast<std::size_t>(std::distance(first, last));
+            auto i = claimed.fetch_add(n, std::memory_order_relaxed);
+            for (; first != last; ++first, ++i) construct(i, std::move(*first));
+        }
+
+        // the number of elements readers can see: [0, size()) are all
+        // constructed, and stay where they are
+        std::size_t size() const noexcept {
+            auto n = published.load(std::memory_order_acquire);
+            const auto limit = claimed.load(std::memory_order_acquire);
+            for (; n < limit; ++n) {
+                auto s = slot(n, std::memory_order_acquire);
+                if (!s || !s->ready.load(std::memory_order_acquire)) break;
+            }
+
+            auto seen = published.load(std::memory_order_relaxed);     // remember
+            while (seen < n && !published.compare_exchange_weak(seen, n, std::memory_order_release,
+                                                                 std::memory_order_relaxed)) {}
+            return n;
+        }
+
+        // i < some earlier size()
+        const T& operator[](std::size_t i) const noexcept {
+            return *slot(i, std::memory_order_acquire)->get();
+        }
+        T& operator[](std::size_t i) noexcept {
+            return *slot(i, std::memory_order_acquire)->get();
+        }
+
+        // calls f on each element of the prefix that's visible now; pushes made
+        // meanwhile go on undisturbed, after it. Returns how many f saw.
+        template<typename F>
+        std::size_t forEach(F&& f) const {
+            auto n = size();
+            for (std::size_t i = 0; i < n; ++i) f((*this)[i]);
+            return n;
+        }
+
+        // a claimed slot may hold nothing: its constructor threw, or an
+        // appendMoved that claimed it stopped short (its segment may not even
+        // exist), so only the ready ones are destroyed
+        void clear() noexcept {
+            const auto n = claimed.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < n; ++i) {
+                auto s = slot(i, std::memory_order_acquire);
+                if (!s || !s->ready.load(std::memory_order_acquire)) continue;
+                s->get()->~T();
+                s->ready.store(false, std::memory_order_relaxed);
+            }
+            for (auto& seg : segments) delete[] seg.exchange(nullptr, std::memory_order_relaxed);
+            claimed.store(0, std::memory_order_relaxed);
+            published.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        struct Slot {
+            alignas(T) unsigned char storage[sizeof(T)];
+            std::atomic<bool> ready{ false };
+
+            T* get() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+        };
+
+        static constexpr std::size_t firstSegment = std::size_t{ 1 } << FirstSegmentBits;
+        static constexpr std::size_t numSegments = 8 * sizeof(std::size_t) - FirstSegmentBits;
+
+        // element i lives in segment k = floor(log2(i + firstSegment)) - FirstSegmentBits,
+        // which holds firstSegment << k elements
+        static std::size_t segmentOf(std::size_t i) noexcept {
+            auto j = i + firstSegment;
+            std::size_t log = FirstSegmentBits;
+            while (j >> (log + 1)) ++log;
+            return log - FirstSegmentBits;
+        }
+
+        static std::size_t segmentStart(std::size_t k) noexcept {
+            return (firstSegment << k) - firstSegment;
+        }
+
+        Slot* slot(std::size_t i, std::memory_order order) const noexcept {
+            auto k = segmentOf(i);
+            auto seg = segments[k].load(order);
+            return seg ? seg + (i - segmentStart(k)) : nullptr;
+        }
+
+        Slot* slotForWriting(std::size_t i) {
+            auto k = segmentOf(i);
+            auto seg = segments[k].load(std::memory_order_acquire);
+            if (!seg) {
+                auto fresh = new Slot[firstSegment << k];
+                if (segments[k].compare_exchange_strong(seg, fresh, std::memory_order_acq_rel,
+                                                        std::memory_order_acquire)) {
+                    seg = fresh;
+                } else {
+                    delete[] fresh;     // another pusher got there first
+                }
+            }
+            return seg + (i - segmentStart(k));
+        }
+
+        // if T's constructor throws, slot i is never marked ready, which hides
+        // everything after it from readers too
+        template<typename... Ts>
+        T& construct(std::size_t i, Ts&&... params) {
+            auto s = slotForWriting(i);
+            auto p = ::new (static_cast<void*>(s->storage)) T(std::forward<Ts>(params)...);
+            s->ready.store(true, std::memory_order_release);
+            return *p;
+        }
+
+        std::array<std::atomic<Slot*>, numSegments> segments{};
+        std::atomic<std::size_t> claimed{ 0 };              // indices handed out
+        mutable std::atomic<std::size_t> published{ 0 };    // known ready prefix
+    };
+
+
+    AppendOnlyRegistry<std::shared_ptr<Widget>> processWidgets;
 
     void Widget::process() {
         // this is raw pointer, enable_shared_from_this works.
@@ -172,11 +462,75 @@ namespace item19 {
         processWidgets.emplace_back(shared_from_this()); // add it to the list of processed Widgets.
     }
 
+    // shared_from_this copies a std::shared_ptr, which is an atomic increment
+    // of the reference count per call. A caller that owns std::shared_ptrs it
+    // doesn't need any more can hand them over instead: moving them in leaves
+    // the counts alone, and the whole batch claims its slots at once.
+    void processAll(std::vector<std::shared_ptr<Widget>>&& widgets) {
+        processWidgets.appendMoved(widgets.begin(), widgets.end());
+        widgets.clear();
+    }
+
 }
 
 
 int main() {
     using namespace item19;
 
+    // upw, spw, pw1 and pw2 each hold a pooled Widget
+    std::cout << "pooled Widgets in use: " << PoolAllocator<Widget>::pool().inUse() << '\n';
+
+    {
+        auto w = Widget::create();      // one pooled block: control block and Widget
+        w->process();
+        processWidgets.clear();
+    }
+
+    // four workers processing Widgets, one at a time and in batches, while
+    // another thread keeps reading what's been processed so far
+    {
+        constexpr auto numWorkers = 4;
+        constexpr auto perWorker = 20'000;
+        std::atomic<bool> done{ false };
+        std::size_t scans = 0, lastSeen = 0;
+
+        std::thread reader([&] {
+            while (!done.load(std::memory_order_acquire)) {
+                auto seen = processWidgets.forEach([](const std::shared_ptr<Widget>& w) {
+                    if (!w) std::cout << "empty slot!" << '\n';
+                });
+                if (seen < lastSeen) std::cout << "prefix shrank!" << '\n';
+                lastSeen = seen;
+                ++scans;
+            }
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (auto t = 0; t < numWorkers; ++t) {
+            workers.emplace_back([] {
+                std::vector<std::shared_ptr<Widget>> batch;
+                for (auto i = 0; i < perWorker; ++i) {
+                    auto w = Widget::create();
+                    if (i % 2 == 0) {
+                        w->process();
+                    } else {
+                        batch.push_back(std::move(w));
+                        if (batch.size() == 256) processAll(std::move(batch));
+                    }
+                }
+                processAll(std::move(batch));
+            });
+        }
+        for (auto& t : workers) t.join();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        done.store(true, std::memory_order_release);
+        reader.join();
+
+        std::cout << processWidgets.size() << " Widgets processed in " << elapsed.count()
+                  << " ms, read concurrently " << scans << " times" << '\n';
+        processWidgets.clear();
+    }
+
     return 0;
 }
@@ -2,6 +2,14 @@
 #include <memory>   // include std::unique_ptr
 #include <vector>
 #include <unordered_map>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <tuple>
 
 
 
@@ -198,6 +206,242 @@ namespace item20 {
         return objPtr;
     }
 
+    // fastLoadWidget isn't safe to call from more than one thread: the static
+    // cache is read and written with no synchronization. A thread-safe cache
+    // splits the ids across NumShards shards, each guarded by its own
+    // std::shared_mutex, so lookups on different shards never contend and
+    // lookups that hit a live std::weak_ptr take only a shared lock.
+    //
+    // Concurrent misses on the same id are coalesced: the first thread to miss
+    // publishes a std::shared_future for the id and calls loadWidget, the others
+    // wait on that future and get the very same std::shared_ptr.
+    //
+    // fastLoadWidget also never erases anything, so every dead Widget leaves a
+    // std::weak_ptr (and the control block it pins) and a map node behind. Here
+    // expired entries are swept from a shard once it has seen as many inserts as
+    // it holds entries (amortized O(1) per insert), sweep() can be called from a
+    // background thread, and an optional maxEntries bound is enforced per shard
+    // with CLOCK (second chance) eviction.
+    template<typename WidgetID, std::size_t NumShards = 16>
+    class ConcurrentWidgetCache {
+    public:
+        static_assert(NumShards != 0 && (NumShards & (NumShards - 1)) == 0,
+                      "NumShards must be a power of two");
+
+        using WidgetPtr = std::shared_ptr<const Widget>;
+
+        struct Stats {
+            std::size_t hits = 0;
+            std::size_t misses = 0;
+            std::size_t expiredOnLookup = 0;    // found an entry, but its Widget was dead
+            std::size_t sweeps = 0;
+            std::size_t reclaimed = 0;          // expired entries erased by sweeps
+            std::size_t evictions = 0;          // live entries erased to respect maxEntries
+        };
+
+        // maxEntries == 0 means unbounded
+        explicit ConcurrentWidgetCache(std::size_t maxEntries = 0)
+            : shardCapacity((maxEntries + NumShards - 1) / NumShards) {}
+
+        WidgetPtr load(const WidgetID& id) {
+            auto& shard = shardFor(id);
+
+            {
+                std::shared_lock<std::shared_mutex> g(shard.m);   // fast path: readers only
+
+                auto it = shard.cache.find(id);
+                if (it != shard.cache.end()) {
+                    if (auto objPtr = it->second.wp.lock()) {
+                        it->second.referenced.store(true, std::memory_order_relaxed);
+                        bump(shard.hits);
+                        return objPtr;
+                    }
+                    bump(shard.expiredOnLookup);
+                }
+            }
+
+            std::unique_lock<std::shared_mutex> g(shard.m);
+
+            auto it = shard.cache.find(id);     // somebody may have loaded it
+            if (it != shard.cache.end()) {      // while we weren't holding m
+                if (auto objPtr = it->second.wp.lock()) {
+                    it->second.referenced.store(true, std::memory_order_relaxed);
+                    bump(shard.hits);
+                    return objPtr;
+                }
+            }
+
+            bump(shard.misses);
+
+            auto pending = shard.loading.find(id);
+            if (pending != shard.loading.end()) {   // another thread is already
+                auto fut = pending->second;         // loading id, wait for it
+                g.unlock();
+                return fut.get();
+            }
+
+            std::promise<WidgetPtr> p;
+            shard.loading.emplace(id, p.get_future().share());
+            g.unlock();
+
+            WidgetPtr objPtr;
+            try {
+                objPtr = loadWidget(id);
+            } catch (...) {
+                g.lock();
+                shard.loading.erase(id);
+                g.unlock();
+                p.set_exception(std::current_exception());
+                throw;
+            }
+
+            g.lock();
+            insert(shard, id, objPtr);
+            shard.loading.erase(id);
+            g.unlock();
+
+            p.set_value(objPtr);
+            return objPtr;
+        }
+
+        // erase every expired entry; cheap enough to run periodically from a
+        // background thread, since it holds one shard's lock at a time
+        void sweep() {
+            for (auto& shard : shards) {
+                std::lock_guard<std::shared_mutex> g(shard.m);
+                sweepShard(shard);
+            }
+        }
+
+        std::size_t size() const {
+            std::size_t n = 0;
+            for (auto& shard : shards) {
+                std::shared_lock<std::shared_mutex> g(shard.m);
+                n += shard.cache.size();
+            }
+            return n;
+        }
+
+        Stats stats() const {
+            Stats s;
+            for (auto& shard : shards) {
+                s.hits += shard.hits.load(std::memory_order_relaxed);
+                s.misses += shard.misses.load(std::memory_order_relaxed);
+                s.expiredOnLookup += shard.expiredOnLookup.load(std::memory_order_relaxed);
+                s.sweeps += shard.sweeps.load(std::memory_order_relaxed);
+                s.reclaimed += shard.reclaimed.load(std::memory_order_relaxed);
+                s.evictions += shard.evictions.load(std::memory_order_relaxed);
+            }
+            return s;
+        }
+
+    private:
+        using Counter = std::atomic<std::size_t>;
+
+        struct Entry {
+            explicit Entry(const WidgetPtr& objPtr) : wp(objPtr) {}
+
+            std::weak_ptr<const Widget> wp;
+            std::atomic<bool> referenced{ true };   // CLOCK bit, set by readers
+        };
+
+        using Map = std::unordered_map<WidgetID, Entry>;
+
+        struct alignas(64) Shard {          // keep each shard's mutex on its own cache line
+            mutable std::shared_mutex m;
+            Map cache;
+            std::unordered_map<WidgetID, std::shared_future<WidgetPtr>> loading;
+
+            std::size_t insertsSinceSweep = 0;
+            bool handValid = false;         // CLOCK hand, remembered by key because
+            WidgetID hand{};                // rehashing invalidates iterators
+
+            Counter hits{ 0 }, misses{ 0 }, expiredOnLookup{ 0 };
+            Counter sweeps{ 0 }, reclaimed{ 0 }, evictions{ 0 };
+        };
+
+        static void bump(Counter& c) { c.fetch_add(1, std::memory_order_relaxed); }
+
+        Shard& shardFor(const WidgetID& id) {
+            auto h = std::hash<WidgetID>{}(id);
+            h ^= h >> 16;                   // std::hash<int> is usually the identity,
+            h *= 0x45d9f3b;                 // so mix the bits before masking
+            h ^= h >> 16;
+            return shards[h & (NumShards - 1)];
+        }
+
+        // called with shard.m held exclusively
+        void insert(Shard& shard, const WidgetID& id, const WidgetPtr& objPtr) {
+            auto it = shard.cache.find(id);
+            if (it != shard.cache.end()) {          // reuse the expired entry's node
+                it->second.wp = objPtr;
+                it->second.referenced.store(true, std::memory_order_relaxed);
+                return;
+            }
+
+            if (++shard.insertsSinceSweep > shard.cache.size()) sweepShard(shard);
+            if (shardCapacity != 0 && shard.cache.size() >= shardCapacity) evictOne(shard);
+
+            shard.cache.emplace(std::piecewise_construct,
+                                std::forward_as_tuple(id),
+                                std::forward_as_tuple(objPtr));
+        }
+
+        // called with shard.m held exclusively
+        void sweepShard(Shard& shard) {
+            std::size_t n = 0;
+            for (auto it = shard.cache.begin(); it != shard.cache.end(); ) {
+                if (it->second.wp.expired()) {
+                    it = shard.cache.erase(it);
+                    ++n;
+                } else {
+                    ++it;
+                }
+            }
+            shard.insertsSinceSweep = 0;
+            shard.handValid = false;
+            bump(shard.sweeps);
+            shard.reclaimed.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        // called with shard.m held exclusively. Sweep the hand around the shard,
+        // giving referenced entries a second chance; an expired entry is always
+        // the first choice. Two laps are enough to find a victim.
+        void evictOne(Shard& shard) {
+            auto& cache = shard.cache;
+            if (cache.empty()) return;
+
+            auto it = shard.handValid ? cache.find(shard.hand) : cache.end();
+            if (it == cache.end()) it = cache.begin();
+
+            for (auto steps = 2 * cache.size(); steps != 0; --steps) {
+                bool expired = it->second.wp.expired();
+                if (expired ||
+                    !it->second.referenced.exchange(false, std::memory_order_relaxed)) {
+                    bump(expired ? shard.reclaimed : shard.evictions);
+                    it = cache.erase(it);
+                    break;
+                }
+                if (++it == cache.end()) it = cache.begin();
+            }
+
+            if (it == cache.end()) it = cache.begin();
+            shard.handValid = (it != cache.end());
+            if (shard.handValid) shard.hand = it->first;
+        }
+
+        std::size_t shardCapacity;
+        std::array<Shard, NumShards> shards;
+    };
+
+    // thread-safe caching version of loadWidget
+    template<typename WidgetID>
+    std::shared_ptr<const Widget> concurrentFastLoadWidget(WidgetID id) {
+        static ConcurrentWidgetCache<WidgetID> cache;
+
+        return cache.load(id);
+    }
+
 
     // Observer design pattern. Each subject contains a data member holding
     // pointers to its observers. A reasonable design is for each subject to
@@ -251,5 +495,27 @@ int main() {
         std::cout << e.what() << '\n';
     }
 
+    // many threads asking for the same ids share the cached Widgets
+    std::vector<std::thread> loaders;
+    for (auto i = 0; i < 4; ++i) {
+        loaders.emplace_back([] {
+            for (auto id = 0; id < 100; ++id) {
+                auto w = concurrentFastLoadWidget(id);
+            }
+        });
+    }
+    for (auto& t : loaders) t.join();
+
+    // a bounded cache; every Widget above died as soon as its loader dropped it
+    ConcurrentWidgetCache<int> bounded(64);
+    std::vector<std::shared_ptr<const Widget>> live;
+    for (auto id = 0; id < 1000; ++id) {
+        live.push_back(bounded.load(id));
+    }
+    auto stats = bounded.stats();
+    std::cout << "entries: " << bounded.size()
+              << ", misses: " << stats.misses
+              << ", evictions: " << stats.evictions << '\n';
+
     return 0;
 }
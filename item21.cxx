@@ -2,6 +2,13 @@
 #include <memory>   // include std::unique_ptr
 #include <vector>
 #include <unordered_map>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <type_traits>
+#include <utility>
 
 
 
@@ -278,6 +285,319 @@ namespace item21 {
 
     //......      // final std::weak_ptr to object destroyed here;
                   // memory for control block is released
+
+
+    // For a ReallyBigType with std::weak_ptrs that outlive it, the choice is
+    // between std::make_shared (one allocation, but the memory isn't released
+    // until the last std::weak_ptr goes) and new (memory released at once, but
+    // two allocations). And either way each std::shared_ptr is two pointers.
+    //
+    // An intrusive pointer avoids all that for types that can carry their own
+    // count. Deriving from RefCounted<T> (CRTP, like enable_shared_from_this)
+    // embeds the count in T; IntrusivePtr<T> is a single pointer, and
+    // makeIntrusive is a single allocation. The Policy says how the count
+    // changes: atomically (ThreadSafe) or, for objects that never leave one
+    // thread, with plain arithmetic (SingleThreaded).
+    //
+    // Types that need weak references derive from WeakRefCounted<T> instead.
+    // The first IntrusiveWeakPtr to an object allocates a small WeakCell for
+    // it, and only the cell outlives the object: the object is destroyed and
+    // its memory freed as soon as the last IntrusivePtr lets go.
+    struct ThreadSafe {
+        using Count = std::atomic<long>;
+
+        // a lock that's only taken by lock(), and by an object going away
+        // while it has a WeakCell
+        using Mutex = std::mutex;
+
+        static void increment(Count& c) noexcept { c.fetch_add(1, std::memory_order_relaxed); }
+
+        // true if that was the last reference
+        static bool release(Count& c) noexcept {
+            if (c.fetch_sub(1, std::memory_order_release) != 1) return false;
+            std::atomic_thread_fence(std::memory_order_acquire);    // see every other
+            return true;                                            // owner's writes
+        }
+
+        static bool incrementIfNonZero(Count& c) noexcept {
+            auto n = c.load(std::memory_order_relaxed);
+            while (n != 0 && !c.compare_exchange_weak(n, n + 1, std::memory_order_relaxed)) {}
+            return n != 0;
+        }
+
+        static long load(const Count& c) noexcept { return c.load(std::memory_order_relaxed); }
+    };
+
+    struct SingleThreaded {
+        using Count = long;
+
+        struct Mutex {
+            void lock() noexcept {}
+            void unlock() noexcept {}
+        };
+
+        static void increment(Count& c) noexcept { ++c; }
+        static bool release(Count& c) noexcept { return --c == 0; }
+        static bool incrementIfNonZero(Count& c) noexcept { return c != 0 && ++c; }
+        static long load(const Count& c) noexcept { return c; }
+    };
+
+    template<typename T>
+    class IntrusivePtr {
+    public:
+        using element_type = T;
+
+        constexpr IntrusivePtr() noexcept = default;
+        constexpr IntrusivePtr(std::nullptr_t) noexcept {}
+
+        // shares ownership of p with any other IntrusivePtrs to it; unlike
+        // std::shared_ptr, making a second one from a raw pointer is fine
+        explicit IntrusivePtr(T* p) noexcept : p(p) { if (p) intrusivePtrAddRef(p); }
+
+        IntrusivePtr(const IntrusivePtr& rhs) noexcept : IntrusivePtr(rhs.p) {}
+        IntrusivePtr(IntrusivePtr&& rhs) noexcept : p(rhs.p) { rhs.p = nullptr; }
+
+        template<typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+        IntrusivePtr(const IntrusivePtr<U>& rhs) noexcept : IntrusivePtr(rhs.get()) {}
+
+        template<typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+        IntrusivePtr(IntrusivePtr<U>&& rhs) noexcept : p(rhs.release()) {}
+
+        ~IntrusivePtr() { if (p) intrusivePtrRelease(p); }
+
+        IntrusivePtr& operator=(IntrusivePtr rhs) noexcept {   // copy and swap
+            swap(rhs);
+            return *this;
+        }
+
+        void reset() noexcept { IntrusivePtr().swap(*this); }
+        void swap(IntrusivePtr& rhs) noexcept { std::swap(p, rhs.p); }
+
+        T* get() const noexcept { return p; }
+        T& operator*() const noexcept { return *p; }
+        T* operator->() const noexcept { return p; }
+        explicit operator bool() const noexcept { return p != nullptr; }
+
+        // gives up ownership without touching the count
+        T* release() noexcept { return std::exchange(p, nullptr); }
+
+        // takes over a reference someone else already counted
+        static IntrusivePtr adopt(T* p) noexcept {
+            IntrusivePtr r;
+            r.p = p;
+            return r;
+        }
+
+    private:
+        T* p = nullptr;
+    };
+
+    template<typename T, typename U>
+    bool operator==(const IntrusivePtr<T>& a, const IntrusivePtr<U>& b) noexcept { return a.get() == b.get(); }
+    template<typename T, typename U>
+    bool operator!=(const IntrusivePtr<T>& a, const IntrusivePtr<U>& b) noexcept { return a.get() != b.get(); }
+
+    template<typename T, typename... Ts>
+    IntrusivePtr<T> makeIntrusive(Ts&&... params) {
+        return IntrusivePtr<T>(new T(std::forward<Ts>(params)...));
+    }
+
+    template<typename Derived, typename Policy = ThreadSafe>
+    class RefCounted {
+    public:
+        long useCount() const noexcept { return Policy::load(refs); }
+
+    protected:
+        RefCounted() noexcept = default;
+        RefCounted(const RefCounted&) noexcept {}                   // a copy is a new
+        RefCounted& operator=(const RefCounted&) noexcept { return *this; }     // object,
+        ~RefCounted() = default;                                    // with its own count
+
+    private:
+        friend void intrusivePtrAddRef(const RefCounted* p) noexcept { Policy::increment(p->refs); }
+
+        friend void intrusivePtrRelease(const RefCounted* p) noexcept {
+            if (Policy::release(p->refs)) delete static_cast<const Derived*>(p);
+        }
+
+        mutable typename Policy::Count refs{ 0 };
+    };
+
+    template<typename T>
+    class IntrusiveWeakPtr;
+
+    template<typename Derived, typename Policy = ThreadSafe>
+    class WeakRefCounted {
+    public:
+        long useCount() const noexcept { return Policy::load(refs); }
+
+    protected:
+        WeakRefCounted() noexcept = default;
+        WeakRefCounted(const WeakRefCounted&) noexcept {}
+        WeakRefCounted& operator=(const WeakRefCounted&) noexcept { return *this; }
+        ~WeakRefCounted() = default;
+
+    private:
+        template<typename T>
+        friend class IntrusiveWeakPtr;
+
+        using WeakRefCountedBase = WeakRefCounted;
+        using PolicyType = Policy;
+
+        // references: one per IntrusiveWeakPtr, plus one from the object
+        // while it's alive
+        struct WeakCell {
+            typename Policy::Count refs{ 1 };
+            typename Policy::Mutex m;
+            const Derived* object;
+
+            explicit WeakCell(const Derived* object) noexcept : object(object) {}
+
+            static void release(WeakCell* c) noexcept {
+                if (Policy::release(c->refs)) delete c;
+            }
+        };
+
+        // a new IntrusiveWeakPtr is made from an IntrusivePtr, so the object
+        // can't be going away while its cell is created
+        WeakCell* weakCell() const {
+            auto c = cell.load(std::memory_order_acquire);
+            if (c) return c;
+
+            auto fresh = new WeakCell(static_cast<const Derived*>(this));
+            if (cell.compare_exchange_strong(c, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return fresh;
+            }
+            delete fresh;
+            return c;
+        }
+
+        friend void intrusivePtrAddRef(const WeakRefCounted* p) noexcept { Policy::increment(p->refs); }
+
+        friend void intrusivePtrRelease(const WeakRefCounted* p) noexcept {
+            if (!Policy::release(p->refs)) return;
+
+            auto c = p->cell.load(std::memory_order_acquire);
+            if (c) {
+                std::lock_guard<typename Policy::Mutex> g(c->m);    // no lock() is
+                c->object = nullptr;                                // looking at p now
+            }
+            delete static_cast<const Derived*>(p);
+            if (c) WeakCell::release(c);
+        }
+
+        mutable typename Policy::Count refs{ 0 };
+        mutable std::atomic<WeakCell*> cell{ nullptr };
+    };
+
+    template<typename T>
+    class IntrusiveWeakPtr {
+    public:
+        IntrusiveWeakPtr() noexcept = default;
+
+        IntrusiveWeakPtr(const IntrusivePtr<T>& p) : c(p ? p->weakCell() : nullptr) {
+            if (c) increment();
+        }
+
+        IntrusiveWeakPtr(const IntrusiveWeakPtr& rhs) noexcept : c(rhs.c) { if (c) increment(); }
+        IntrusiveWeakPtr(IntrusiveWeakPtr&& rhs) noexcept : c(std::exchange(rhs.c, nullptr)) {}
+
+        ~IntrusiveWeakPtr() { if (c) Cell::release(c); }
+
+        IntrusiveWeakPtr& operator=(IntrusiveWeakPtr rhs) noexcept {
+            std::swap(c, rhs.c);
+            return *this;
+        }
+
+        // an owning pointer, or null if the object's already gone
+        IntrusivePtr<T> lock() const {
+            if (!c) return nullptr;
+            std::lock_guard<Mutex> g(c->m);
+            if (!c->object || !Policy::incrementIfNonZero(c->object->refs)) return nullptr;
+            return IntrusivePtr<T>::adopt(const_cast<T*>(static_cast<const T*>(c->object)));
+        }
+
+        bool expired() const { return !lock(); }
+
+    private:
+        using Base = typename T::WeakRefCountedBase;
+        using Policy = typename Base::PolicyType;
+        using Cell = typename Base::WeakCell;
+        using Mutex = typename Policy::Mutex;
+
+        void increment() noexcept { Policy::increment(c->refs); }
+
+        Cell* c = nullptr;
+    };
+
+
+    // vpw from Item 19, a million times over: the same Widgets held by
+    // std::shared_ptr (from make_shared) and by IntrusivePtr with each policy.
+    // Copying the container is where the count changes; visiting it is where
+    // the pointer's size shows.
+    struct SharedWidget {
+        explicit SharedWidget(int value) : value(value) {}
+        int value;
+    };
+
+    struct IntrusiveWidget: RefCounted<IntrusiveWidget> {
+        explicit IntrusiveWidget(int value) : value(value) {}
+        int value;
+    };
+
+    struct LocalWidget: RefCounted<LocalWidget, SingleThreaded> {
+        explicit LocalWidget(int value) : value(value) {}
+        int value;
+    };
+
+    template<typename Ptr, typename Make>
+    void timeVpw(const char* label, Make make, int n = 1'000'000) {
+        using Clock = std::chrono::steady_clock;
+        auto nsPer = [n](Clock::duration d) { return std::chrono::duration<double, std::nano>(d).count() / n; };
+
+        auto t0 = Clock::now();
+        std::vector<Ptr> vpw;
+        vpw.reserve(n);
+        for (auto i = 0; i < n; ++i) vpw.push_back(make(i));
+        auto t1 = Clock::now();
+        auto copy = vpw;
+        auto t2 = Clock::now();
+        long long sum = 0;
+        for (const auto& p : copy) sum += p->value;
+        auto t3 = Clock::now();
+        copy.clear();
+        vpw.clear();
+        auto t4 = Clock::now();
+
+        std::cout << "  " << label << " (" << sizeof(Ptr) << " bytes): create " << nsPer(t1 - t0)
+                  << ", copy " << nsPer(t2 - t1) << ", visit " << nsPer(t3 - t2)
+                  << ", destroy " << nsPer(t4 - t3) << " ns each" << (sum < 0 ? "!" : "") << '\n';
+    }
+
+    void benchmarkPointers() {
+        std::cout << "vector of pointers to a million Widgets:" << '\n';
+        timeVpw<std::shared_ptr<SharedWidget>>("std::shared_ptr   ",
+                                               [](int i) { return std::make_shared<SharedWidget>(i); });
+        timeVpw<IntrusivePtr<IntrusiveWidget>>("IntrusivePtr      ",
+                                               [](int i) { return makeIntrusive<IntrusiveWidget>(i); });
+        timeVpw<IntrusivePtr<LocalWidget>>("IntrusivePtr local",
+                                           [](int i) { return makeIntrusive<LocalWidget>(i); });
+    }
+
+
+    // ReallyBigType again, with weak references that outlive it
+    class WeakBigType: public WeakRefCounted<WeakBigType> {
+    public:
+        WeakBigType() { ++alive; }
+        ~WeakBigType() { --alive; }
+
+        static int alive;
+
+    private:
+        std::array<char, 1 << 20> data{};
+    };
+
+    int WeakBigType::alive = 0;
 }
 
 
@@ -297,6 +617,20 @@ int main() {
     auto initList = {10, 20};
     auto spv = std::make_shared<std::vector<int>>(initList);
 
+    static_assert(sizeof(IntrusivePtr<IntrusiveWidget>) == sizeof(IntrusiveWidget*),
+                  "an IntrusivePtr is just a pointer");
+
+    {
+        auto big = makeIntrusive<WeakBigType>();
+        IntrusiveWeakPtr<WeakBigType> weak(big);
+        std::cout << "locked while alive: " << std::boolalpha << (weak.lock() == big) << '\n';
+        big.reset();                        // the object and its megabyte go now,
+        std::cout << "alive after the last IntrusivePtr: " << WeakBigType::alive
+                  << ", expired: " << weak.expired() << '\n';
+    }                                       // and only the WeakCell here
+
+    benchmarkPointers();
+
 
     return 0;
 }
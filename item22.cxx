@@ -2,6 +2,14 @@
 #include <memory>   // include std::unique_ptr
 #include <vector>
 #include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
 
 #include <boost/type_index.hpp>
 
@@ -25,6 +33,162 @@
  *    very large objects, and std::weak_ptrs that outlive the corresponding std::shared_ptrs.
  * */
 
+// Counting instrumentation for the items whose advice is about how many
+// allocations, copies and moves happen (17, 22, 41, 42). Every dynamic
+// allocation in the program goes through the replacement global operator new
+// and delete below, which count them; an AllocationScope reports what has
+// happened since it was created. CountingType counts calls of its own special
+// member functions the same way (a CountingScope reads them), and prints each
+// one while CountingType::log is set. expect() checks a count against the
+// number the item predicts; main's exit status is whether they all held.
+namespace accounting {
+    std::atomic<std::size_t> allocations{ 0 };
+    std::atomic<std::size_t> deallocations{ 0 };
+    std::atomic<std::size_t> bytesAllocated{ 0 };
+
+    struct AllocationCounts {
+        std::size_t allocations;
+        std::size_t deallocations;
+        std::size_t bytes;
+    };
+
+    AllocationCounts allocationTotals() noexcept {
+        return { allocations.load(std::memory_order_relaxed),
+                 deallocations.load(std::memory_order_relaxed),
+                 bytesAllocated.load(std::memory_order_relaxed) };
+    }
+
+    class AllocationScope {
+    public:
+        AllocationScope() noexcept : start(allocationTotals()) {}
+
+        AllocationCounts counts() const noexcept {
+            auto now = allocationTotals();
+            return { now.allocations - start.allocations,
+                     now.deallocations - start.deallocations,
+                     now.bytes - start.bytes };
+        }
+
+        std::size_t allocations() const noexcept { return counts().allocations; }
+        std::size_t deallocations() const noexcept { return counts().deallocations; }
+
+    private:
+        AllocationCounts start;
+    };
+
+    struct SpecialMemberCounts {
+        std::size_t constructs;         // from a value, or by default
+        std::size_t copyConstructs;
+        std::size_t moveConstructs;
+        std::size_t copyAssigns;
+        std::size_t moveAssigns;
+        std::size_t destructs;
+    };
+
+    // The counts are plain integers, so only one thread at a time should be
+    // using CountingTypes. The converting constructor is implicit so that a
+    // CountingType can stand in for an element type built from a different
+    // argument type (Item 42's std::string from a const char*).
+    class CountingType {
+    public:
+        CountingType() noexcept : CountingType(0) {}
+        CountingType(int value) noexcept : value(value) { note(counts.constructs, "constructed"); }
+
+        CountingType(const CountingType& rhs) noexcept : value(rhs.value) {
+            note(counts.copyConstructs, "copy constructed");
+        }
+        CountingType(CountingType&& rhs) noexcept : value(rhs.value) {
+            note(counts.moveConstructs, "move constructed");
+        }
+
+        CountingType& operator=(const CountingType& rhs) noexcept {
+            value = rhs.value;
+            note(counts.copyAssigns, "copy assigned");
+            return *this;
+        }
+        CountingType& operator=(CountingType&& rhs) noexcept {
+            value = rhs.value;
+            note(counts.moveAssigns, "move assigned");
+            return *this;
+        }
+
+        ~CountingType() { note(counts.destructs, "destroyed"); }
+
+        friend bool operator<(const CountingType& lhs, const CountingType& rhs) noexcept {
+            return lhs.value < rhs.value;
+        }
+
+        int value;
+
+        static SpecialMemberCounts counts;
+        static bool log;
+
+    private:
+        void note(std::size_t& count, const char* what) const noexcept {
+            ++count;
+            if (log) std::cout << "    CountingType(" << value << ") " << what << '\n';
+        }
+    };
+
+    SpecialMemberCounts CountingType::counts{};
+    bool CountingType::log = false;
+
+    class CountingScope {
+    public:
+        CountingScope() noexcept : start(CountingType::counts) {}
+
+        SpecialMemberCounts counts() const noexcept {
+            auto& now = CountingType::counts;
+            return { now.constructs - start.constructs,
+                     now.copyConstructs - start.copyConstructs,
+                     now.moveConstructs - start.moveConstructs,
+                     now.copyAssigns - start.copyAssigns,
+                     now.moveAssigns - start.moveAssigns,
+                     now.destructs - start.destructs };
+        }
+
+    private:
+        SpecialMemberCounts start;
+    };
+
+    int failureCount = 0;
+
+    bool expect(const char* what, std::size_t actual, std::size_t expected) {
+        const bool held = actual == expected;
+        if (!held) ++failureCount;
+
+        std::cout << (held ? "  ok    " : "  FAIL  ") << what << ": " << actual;
+        if (!held) std::cout << " (expected " << expected << ")";
+        std::cout << '\n';
+        return held;
+    }
+
+    int failures() noexcept { return failureCount; }
+}
+
+void* operator new(std::size_t size) {
+    accounting::allocations.fetch_add(1, std::memory_order_relaxed);
+    accounting::bytesAllocated.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+// GCC pairs the std::free here with the std::malloc in operator new only while
+// operator delete does nothing else, and otherwise flags every inlined
+// deallocation as mismatched
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+    if (p) accounting::deallocations.fetch_add(1, std::memory_order_relaxed);
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept { ::operator delete(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
 namespace item18 {
     // A common use for std::unique_ptr is as a factory function return type for objects
     // in a hierarchy. Suppose we have a hierarchy for types of investments (e.g., stocks,
@@ -378,6 +542,359 @@ namespace item22 {
         }
     }
 
+    // Fast Pimpl. The std::unique_ptr version pays for its build firewall
+    // with a heap allocation per Widget constructed or copied, and an extra
+    // pointer to follow on every access. FastPimpl keeps the firewall but
+    // puts the Impl in aligned storage inside the Widget itself: the header
+    // commits to a size and alignment, not to the Impl's definition.
+    //
+    // Same rule as for std::unique_ptr: none of FastPimpl's special member
+    // functions are instantiated until the Widget's are, so as long as
+    // those are defined in the implementation file, where Impl is complete,
+    // the static_asserts checking that Impl fits are evaluated there, too.
+    //
+    // A variadic forwarding constructor is a better match than the copy
+    // constructor for a non-const lvalue (Item 26), so it's disabled when its
+    // only argument is the class itself (Item 27).
+    template<typename Self, typename... Ts>
+    struct IsSoleArgument : std::false_type {};
+
+    template<typename Self, typename T>
+    struct IsSoleArgument<Self, T> : std::is_same<Self, std::decay_t<T>> {};
+
+    template<typename T, std::size_t Size, std::size_t Align = alignof(std::max_align_t)>
+    class FastPimpl {
+    public:
+        template<typename... Ts,
+                 typename = std::enable_if_t<!IsSoleArgument<FastPimpl, Ts...>::value>>
+        explicit FastPimpl(Ts&&... params) { ::new (ptr()) T(std::forward<Ts>(params)...); }
+
+        FastPimpl(const FastPimpl& rhs) { ::new (ptr()) T(*rhs); }
+        FastPimpl(FastPimpl&& rhs) noexcept { ::new (ptr()) T(std::move(*rhs)); }
+
+        FastPimpl& operator=(const FastPimpl& rhs) { **this = *rhs; return *this; }
+        FastPimpl& operator=(FastPimpl&& rhs) noexcept { **this = std::move(*rhs); return *this; }
+
+        ~FastPimpl() {
+            validate<sizeof(T), alignof(T)>();
+            ptr()->~T();
+        }
+
+        T* operator->() noexcept { return ptr(); }
+        const T* operator->() const noexcept { return ptr(); }
+        T& operator*() noexcept { return *ptr(); }
+        const T& operator*() const noexcept { return *ptr(); }
+
+    private:
+        // the actual size and alignment show up in the error message
+        template<std::size_t ActualSize, std::size_t ActualAlign>
+        static void validate() noexcept {
+            static_assert(ActualSize <= Size, "FastPimpl: Size too small for T");
+            static_assert(Align % ActualAlign == 0, "FastPimpl: Align incompatible with T");
+            static_assert(std::is_nothrow_move_constructible<T>::value
+                          && std::is_nothrow_move_assignable<T>::value,
+                          "FastPimpl: T's moves must be noexcept");
+        }
+
+        T* ptr() noexcept { return std::launder(reinterpret_cast<T*>(&storage)); }
+        const T* ptr() const noexcept { return std::launder(reinterpret_cast<const T*>(&storage)); }
+
+        std::aligned_storage_t<Size, Align> storage;
+    };
+
+    namespace fast {
+        class Widget {                      // in "widget.h"
+        public:
+            Widget();
+            ~Widget();
+
+            Widget(Widget&& rhs) noexcept;
+            Widget& operator=(Widget&& rhs) noexcept;
+            Widget(const Widget& rhs);
+            Widget& operator=(const Widget& rhs);
+        private:
+            struct Impl;
+            FastPimpl<Impl, 64> pImpl;      // room for a std::string, a std::vector
+        };                                  // and the Gadgets on common ABIs
+
+
+        // ==================================
+        // #include "widget.h"              // in impl. file "widget.cpp"
+        // #include "gadget.h"
+        // #include <string>
+        // #include <vector>
+
+        struct Widget::Impl {
+            std::string name;
+            std::vector<double> data;
+            Gadget g1, g2, g3;
+        };
+
+        Widget::Widget() = default;         // no allocation
+        Widget::~Widget() = default;
+
+        Widget::Widget(Widget&& rhs) noexcept = default;
+        Widget& Widget::operator=(Widget&& rhs) noexcept = default;
+        Widget::Widget(const Widget& rhs) = default;
+        Widget& Widget::operator=(const Widget& rhs) = default;
+    }
+
+    // Copy-on-write. cxx11::Widget deep-copies name and data on every copy,
+    // which is wasted work when copies are mostly read. CowPtr shares one
+    // Impl between copies through an atomic reference count, so copying is
+    // an increment; write() hands out a mutable Impl, cloning it first if
+    // anyone else still refers to it.
+    //
+    // As with FastPimpl, the operations needing a complete T are only
+    // instantiated in the implementation file.
+    template<typename T>
+    class CowPtr {
+    public:
+        template<typename... Ts,
+                 typename = std::enable_if_t<!IsSoleArgument<CowPtr, Ts...>::value>>
+        explicit CowPtr(Ts&&... params): node(new Node(std::forward<Ts>(params)...)) {}
+
+        CowPtr(const CowPtr& rhs) noexcept: node(rhs.node) { acquire(); }
+        CowPtr(CowPtr&& rhs) noexcept: node(rhs.node) { rhs.node = nullptr; }
+
+        CowPtr& operator=(const CowPtr& rhs) noexcept {
+            CowPtr(rhs).swap(*this);
+            return *this;
+        }
+        CowPtr& operator=(CowPtr&& rhs) noexcept {
+            CowPtr(std::move(rhs)).swap(*this);
+            return *this;
+        }
+
+        ~CowPtr() { release(); }
+
+        void swap(CowPtr& rhs) noexcept { std::swap(node, rhs.node); }
+
+        // a moved-from CowPtr reads as a default-constructed T
+        const T& read() const { return node ? node->value : empty(); }
+
+        // The acquire load pairs with the release half of other owners'
+        // decrements, so their last reads of the Impl happen before our
+        // writes to it when they've all let go. A moved-from CowPtr gets a
+        // fresh T.
+        T& write() {
+            if (!node) node = new Node();
+            else if (node->refs.load(std::memory_order_acquire) != 1) {
+                auto copy = new Node(node->value);
+                release();
+                node = copy;
+            }
+            return node->value;
+        }
+
+        bool shared() const noexcept {
+            return node && node->refs.load(std::memory_order_acquire) != 1;
+        }
+
+    private:
+        static const T& empty() {
+            static const T value{};
+            return value;
+        }
+
+        struct Node {
+            template<typename... Ts>
+            explicit Node(Ts&&... params): value(std::forward<Ts>(params)...) {}
+
+            std::atomic<long> refs{ 1 };
+            T value;
+        };
+
+        void acquire() noexcept {
+            if (node) node->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        void release() noexcept {
+            if (node && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete node;
+        }
+
+        Node* node;
+    };
+
+    namespace cow {
+        class Widget {                      // in "widget.h"
+        public:
+            Widget();
+            ~Widget();
+
+            Widget(Widget&& rhs) noexcept;
+            Widget& operator=(Widget&& rhs) noexcept;
+            Widget(const Widget& rhs) noexcept;             // O(1): shares the Impl
+            Widget& operator=(const Widget& rhs) noexcept;
+
+            const std::string& name() const;                // reads never copy
+            const std::vector<double>& data() const;
+
+            void setName(std::string newName);              // the first write after
+            void append(double value);                      // a copy clones the Impl
+
+            bool sharesImpl() const noexcept;
+        private:
+            struct Impl;
+            CowPtr<Impl> pImpl;
+        };
+
+
+        // ==================================
+        // #include "widget.h"              // in impl. file "widget.cpp"
+        // #include "gadget.h"
+        // #include <string>
+        // #include <vector>
+
+        struct Widget::Impl {
+            std::string name;
+            std::vector<double> data;
+            Gadget g1, g2, g3;
+        };
+
+        Widget::Widget() = default;
+        Widget::~Widget() = default;
+
+        Widget::Widget(Widget&& rhs) noexcept = default;
+        Widget& Widget::operator=(Widget&& rhs) noexcept = default;
+        Widget::Widget(const Widget& rhs) noexcept = default;
+        Widget& Widget::operator=(const Widget& rhs) noexcept = default;
+
+        const std::string& Widget::name() const { return pImpl.read().name; }
+        const std::vector<double>& Widget::data() const { return pImpl.read().data; }
+
+        void Widget::setName(std::string newName) { pImpl.write().name = std::move(newName); }
+        void Widget::append(double value) { pImpl.write().data.push_back(value); }
+
+        bool Widget::sharesImpl() const noexcept { return pImpl.shared(); }
+    }
+
+    // Per-Widget cost of the vector operations that dominate in practice:
+    // building a vector of n Widgets, copying it, and growing one without
+    // reserve(). cxx11::Widget's move ctor isn't declared noexcept, so
+    // std::vector copies its elements when it grows; fast::Widget's moves
+    // are noexcept, and they don't allocate.
+    template<typename W>
+    void timeWidgetVector(const char* label, std::size_t n) {
+        using Clock = std::chrono::steady_clock;
+        auto nsPer = [n](Clock::duration d) {
+            return std::chrono::duration<double, std::nano>(d).count() / n;
+        };
+
+        auto t0 = Clock::now();
+        std::vector<W> widgets(n);
+        auto t1 = Clock::now();
+        auto copies = widgets;
+        auto t2 = Clock::now();
+        std::vector<W> grown;
+        for (std::size_t i = 0; i < n; ++i) grown.emplace_back();
+        auto t3 = Clock::now();
+
+        std::cout << "  " << label << ": construct " << nsPer(t1 - t0)
+                  << " ns, copy " << nsPer(t2 - t1)
+                  << " ns, grow " << nsPer(t3 - t2) << " ns per Widget" << '\n';
+    }
+
+    void benchmarkPimpl() {
+        constexpr std::size_t n = 1'000'000;
+        std::cout << "vector of " << n << " Widgets" << '\n';
+        timeWidgetVector<cxx11::Widget>("unique_ptr pimpl", n);
+        timeWidgetVector<fast::Widget>("fast pimpl      ", n);
+        timeWidgetVector<cow::Widget>("cow pimpl       ", n);
+    }
+
+    // Copying a populated Widget, read-mostly: deep copy versus shared Impl.
+    void benchmarkCopies() {
+        using Clock = std::chrono::steady_clock;
+        constexpr std::size_t copies = 100'000;
+        constexpr std::size_t values = 1'000;
+
+        cxx11::Widget deep;
+        deep.pImpl->name = "a Widget with a name too long for the small buffer";
+        deep.pImpl->data.assign(values, 1.0);
+
+        cow::Widget shared;
+        shared.setName(deep.pImpl->name);
+        for (std::size_t i = 0; i < values; ++i) shared.append(1.0);
+
+        double sink = 0;
+        auto t0 = Clock::now();
+        for (std::size_t i = 0; i < copies; ++i) {
+            cxx11::Widget w(deep);
+            sink += w.pImpl->data.back();
+        }
+        auto t1 = Clock::now();
+        for (std::size_t i = 0; i < copies; ++i) {
+            cow::Widget w(shared);
+            sink += w.data().back();
+        }
+        auto t2 = Clock::now();
+
+        auto nsPer = [](Clock::duration d) {
+            return std::chrono::duration<double, std::nano>(d).count() / copies;
+        };
+        std::cout << "copy and read a Widget holding " << values << " doubles: deep "
+                  << nsPer(t1 - t0) << " ns, cow " << nsPer(t2 - t1) << " ns"
+                  << " (checksum " << sink << ")" << '\n';
+    }
+
+    // Exact allocation counts for copying and moving each Widget. The names fit
+    // std::string's small buffer, so a deep copy allocates the Impl (for
+    // cxx11::Widget only) and one block for the doubles. Growing a vector
+    // copies cxx11::Widgets, since their move constructor isn't noexcept, but
+    // moves fast::Widgets.
+    template<typename W>
+    void checkGrowth(const char* label, std::size_t expected) {
+        std::vector<W> widgets(4);
+        widgets.shrink_to_fit();
+
+        accounting::AllocationScope scope;
+        widgets.emplace_back();
+        auto allocations = scope.allocations();
+
+        std::string what = std::string(label) + ": allocations growing a vector of 4";
+        accounting::expect(what.c_str(), allocations, expected);
+    }
+
+    void checkCounts() {
+        using accounting::AllocationScope;
+        using accounting::expect;
+
+        cxx11::Widget deep;
+        deep.pImpl->name = "deep";
+        deep.pImpl->data.assign(3, 1.0);
+        {
+            AllocationScope scope;
+            cxx11::Widget copy(deep);
+            expect("unique_ptr pimpl: allocations per copy (Impl, data)", scope.allocations(), 2);
+            AllocationScope moving;
+            cxx11::Widget moved(std::move(copy));
+            expect("unique_ptr pimpl: allocations per move", moving.allocations(), 0);
+        }
+
+        fast::Widget inline1;
+        {
+            AllocationScope scope;
+            fast::Widget copy(inline1);
+            fast::Widget moved(std::move(copy));
+            expect("fast pimpl: allocations per copy and move", scope.allocations(), 0);
+        }
+
+        cow::Widget shared;
+        shared.setName("cow");
+        shared.append(1.0);
+        {
+            AllocationScope scope;
+            cow::Widget copy(shared);
+            expect("cow pimpl: allocations per copy", scope.allocations(), 0);
+            AllocationScope writing;
+            copy.setName("written");
+            expect("cow pimpl: first write after a copy (node, data)", writing.allocations(), 2);
+        }
+
+        checkGrowth<cxx11::Widget>("unique_ptr pimpl", 1 + 4 + 1);   // buffer, copies, new Widget
+        checkGrowth<fast::Widget>("fast pimpl", 1);
+    }
+
 }
 
 
@@ -386,5 +903,20 @@ int main() {
         using namespace item22::cxx11;
     }
 
-    return 0;
+    static_assert(std::is_nothrow_move_constructible<item22::fast::Widget>::value, "");
+    item22::benchmarkPimpl();
+
+    {
+        item22::cow::Widget w1;
+        w1.setName("w1");
+        auto w2 = w1;                       // shares w1's Impl
+        std::cout << "after copy, shared: " << w2.sharesImpl() << '\n';
+        w2.setName("w2");                   // w2 gets its own Impl
+        std::cout << "after write, shared: " << w2.sharesImpl()
+                  << ", names: " << w1.name() << " " << w2.name() << '\n';
+    }
+    item22::benchmarkCopies();
+    item22::checkCounts();
+
+    return accounting::failures() == 0 ? 0 : 1;
 }
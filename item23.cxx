@@ -1,4 +1,26 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define ITEM23_RDTSC 1
+#endif
 
 
 // ITEM 23: Understand std::move and std::forward
@@ -60,7 +82,10 @@ namespace item23 {
     class Widget {
     public:
         //Widget(Widget&& rhs) : s(std::move(rhs.s)) {
-        Widget(Widget&& rhs) : s(std::forward<std::string>(rhs.s)) {
+        //
+        // noexcept, like std::string's move constructor: std::vector only
+        // moves elements when it grows if their move can't throw (Item 14)
+        Widget(Widget&& rhs) noexcept : s(std::forward<std::string>(rhs.s)) {
             ++moveCtorCalls;
         }
 
@@ -74,6 +99,341 @@ namespace item23 {
         std::string s;
     };
 
+    std::size_t Widget::moveCtorCalls = 0;
+
+    // the audit: every value type here that's meant to be moved
+    static_assert(std::is_nothrow_move_constructible<Widget>::value, "Widget's move must be noexcept");
+
+    // Relocating an object (moving it to new storage, then destroying the
+    // original) is, for most types, the same as copying its bytes and
+    // forgetting the original. The compiler can't tell which types those are,
+    // so IsRelocatable has to: trivially copyable types are, and so is a
+    // std::unique_ptr with the default deleter, which is just a pointer.
+    // libstdc++'s std::string isn't, since a short string points into its own
+    // buffer; libc++'s has no such pointer.
+    template<typename T>
+    struct IsRelocatable : std::is_trivially_copyable<T> {};
+
+    template<typename T>
+    struct IsRelocatable<std::unique_ptr<T>> : std::true_type {};
+
+#if defined(_LIBCPP_VERSION)
+    template<>
+    struct IsRelocatable<std::string> : std::true_type {};
+#endif
+
+    // a Widget is nothing but its string. (Relocation bypasses the move
+    // constructor, so moveCtorCalls doesn't count Widgets that are relocated.)
+    template<>
+    struct IsRelocatable<Widget> : IsRelocatable<std::string> {};
+
+    // A vector that grows relocatable element types with std::realloc, which
+    // copies the bytes (or extends the block in place) and runs no move
+    // constructors or destructors at all. Other types are moved one by one,
+    // as std::vector does.
+    template<typename T>
+    class RelocatingVector {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "RelocatingVector: T is overaligned");
+
+    public:
+        static constexpr bool relocates = IsRelocatable<T>::value;
+
+        RelocatingVector() noexcept = default;
+        RelocatingVector(const RelocatingVector&) = delete;
+        RelocatingVector& operator=(const RelocatingVector&) = delete;
+
+        ~RelocatingVector() {
+            clear();
+            std::free(elems);
+        }
+
+        template<typename... Ts>
+        T& emplace_back(Ts&&... params) {
+            if (count == cap) grow(cap ? cap * 2 : 4);
+            auto p = ::new (static_cast<void*>(elems + count)) T(std::forward<Ts>(params)...);
+            ++count;
+            return *p;
+        }
+
+        void push_back(const T& x) { emplace_back(x); }
+        void push_back(T&& x) { emplace_back(std::move(x)); }
+
+        void reserve(std::size_t n) {
+            if (n > cap) grow(n);
+        }
+
+        void clear() noexcept {
+            for (std::size_t i = 0; i < count; ++i) elems[i].~T();
+            count = 0;
+        }
+
+        std::size_t size() const noexcept { return count; }
+        std::size_t capacity() const noexcept { return cap; }
+
+        T& operator[](std::size_t i) noexcept { return elems[i]; }
+        const T& operator[](std::size_t i) const noexcept { return elems[i]; }
+
+        T* begin() noexcept { return elems; }
+        T* end() noexcept { return elems + count; }
+
+    private:
+        void grow(std::size_t newCap) {
+            grow(newCap, IsRelocatable<T>());
+            cap = newCap;
+        }
+
+        // relocatable: realloc copies the bytes, or extends the block in place
+        void grow(std::size_t newCap, std::true_type) {
+            auto p = std::realloc(static_cast<void*>(elems), newCap * sizeof(T));
+            if (!p) throw std::bad_alloc();
+            elems = static_cast<T*>(p);
+        }
+
+        void grow(std::size_t newCap, std::false_type) {
+            auto p = static_cast<T*>(std::malloc(newCap * sizeof(T)));
+            if (!p) throw std::bad_alloc();
+
+            std::size_t i = 0;
+            try {
+                for (; i < count; ++i) ::new (static_cast<void*>(p + i)) T(std::move_if_noexcept(elems[i]));
+            } catch (...) {
+                while (i != 0) p[--i].~T();
+                std::free(p);
+                throw;
+            }
+
+            for (i = 0; i < count; ++i) elems[i].~T();
+            std::free(elems);
+            elems = p;
+        }
+
+        T* elems = nullptr;
+        std::size_t count = 0;
+        std::size_t cap = 0;
+    };
+
+    // makeLogEntry would format and write a line on every forwarded call. The
+    // tracer below does neither on the calling thread: an event is a 32-byte
+    // binary record (a timestamp, the event's name, one argument) pushed onto a
+    // ring buffer owned by the thread, and a background thread drains the rings
+    // into a file that chrome://tracing or Perfetto can open. Names are string
+    // literals recorded by address, so interning them costs nothing at run
+    // time; only the drain looks at the characters. Timestamps are the CPU's
+    // time-stamp counter where there is one, converted to microseconds when
+    // written. A full ring drops events (and counts them) rather than block.
+    namespace trace {
+        struct Record {
+            std::uint64_t ticks;
+            const char* name;
+            std::uint64_t arg;
+            char phase;                 // 'B'egin, 'E'nd or 'i'nstant
+        };
+
+        inline std::uint64_t ticks() noexcept {
+#ifdef ITEM23_RDTSC
+            return __rdtsc();
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        // single producer (the owning thread), single consumer (the drain)
+        class ThreadBuffer {
+        public:
+            static constexpr std::size_t capacity = 4096;
+
+            explicit ThreadBuffer(std::uint32_t tid) : tid(tid), records(new Record[capacity]) {}
+
+            bool tryPush(const Record& r) noexcept {
+                auto h = head.load(std::memory_order_relaxed);
+                if (h - cachedTail == capacity) {
+                    cachedTail = tail.load(std::memory_order_acquire);
+                    if (h - cachedTail == capacity) {
+                        dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                        return false;
+                    }
+                }
+                records[h & (capacity - 1)] = r;
+                head.store(h + 1, std::memory_order_release);
+                return true;
+            }
+
+            template<typename F>
+            void drain(F&& f) {
+                auto t = tail.load(std::memory_order_relaxed);
+                const auto h = head.load(std::memory_order_acquire);
+                for (; t != h; ++t) f(records[t & (capacity - 1)]);
+                tail.store(t, std::memory_order_release);
+            }
+
+            const std::uint32_t tid;
+            std::atomic<std::uint64_t> dropped{ 0 };
+
+        private:
+            std::unique_ptr<Record[]> records;
+            alignas(64) std::atomic<std::uint64_t> head{ 0 };
+            std::uint64_t cachedTail = 0;                       // producer's copy
+            alignas(64) std::atomic<std::uint64_t> tail{ 0 };
+        };
+
+        class Tracer {
+        public:
+            static Tracer& instance() {
+                static Tracer* t = new Tracer;      // never destroyed: threads may
+                return *t;                          // still trace during exit
+            }
+
+            bool enabled() const noexcept { return on.load(std::memory_order_relaxed); }
+
+            void record(char phase, const char* name, std::uint64_t arg) {
+                if (!enabled()) return;
+                threadBuffer().tryPush({ ticks(), name, arg, phase });
+            }
+
+            // begin writing events to path; false if it can't be opened
+            bool start(const std::string& path) {
+                std::lock_guard<std::mutex> g(controlM);
+                if (drainer.joinable()) return false;
+
+                out.open(path, std::ios::trunc);
+                if (!out) return false;
+                out << "[";
+                firstEvent = true;
+                calibrate();
+
+                running = true;
+                drainer = std::thread([this] { drainLoop(); });
+                on.store(true, std::memory_order_relaxed);
+                return true;
+            }
+
+            // stop recording, write out whatever's left and close the file
+            void stop() {
+                std::lock_guard<std::mutex> g(controlM);
+                if (!drainer.joinable()) return;
+
+                on.store(false, std::memory_order_relaxed);
+                {
+                    std::lock_guard<std::mutex> lk(drainM);
+                    running = false;
+                }
+                drainCv.notify_one();
+                drainer.join();
+
+                drainAll();
+                out << "\n]\n";
+                out.close();
+            }
+
+            std::uint64_t dropped() {
+                std::lock_guard<std::mutex> g(buffersM);
+                std::uint64_t n = 0;
+                for (auto& b : buffers) n += b->dropped.load(std::memory_order_relaxed);
+                return n;
+            }
+
+        private:
+            Tracer() = default;
+
+            ThreadBuffer& threadBuffer() {
+                thread_local ThreadBuffer* mine = nullptr;
+                if (!mine) {
+                    std::lock_guard<std::mutex> g(buffersM);
+                    buffers.push_back(std::make_unique<ThreadBuffer>(static_cast<std::uint32_t>(buffers.size() + 1)));
+                    mine = buffers.back().get();     // owned here, so events a thread
+                }                                    // leaves behind still get written
+                return *mine;
+            }
+
+            // microseconds per tick, measured over a few milliseconds
+            void calibrate() {
+                auto steady0 = std::chrono::steady_clock::now();
+                auto ticks0 = ticks();
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                auto elapsed = std::chrono::steady_clock::now() - steady0;
+                auto elapsedTicks = ticks() - ticks0;
+                usPerTick = std::chrono::duration<double, std::micro>(elapsed).count() /
+                            static_cast<double>(elapsedTicks ? elapsedTicks : 1);
+                tickOrigin = ticks0;
+            }
+
+            void drainLoop() {
+                std::unique_lock<std::mutex> lk(drainM);
+                while (running) {
+                    drainCv.wait_for(lk, std::chrono::milliseconds(2));
+                    lk.unlock();
+                    drainAll();
+                    lk.lock();
+                }
+            }
+
+            void drainAll() {
+                std::lock_guard<std::mutex> g(buffersM);
+                for (auto& b : buffers) {
+                    b->drain([&](const Record& r) { write(r, b->tid); });
+                }
+                out.flush();
+            }
+
+            void write(const Record& r, std::uint32_t tid) {
+                auto us = static_cast<double>(static_cast<std::int64_t>(r.ticks - tickOrigin)) * usPerTick;
+
+                out << (firstEvent ? "\n" : ",\n") << "{\"name\":\"";
+                for (auto p = r.name; *p; ++p) {
+                    if (*p == '"' || *p == '\\') out << '\\';
+                    out << *p;
+                }
+                out << "\",\"ph\":\"" << r.phase << "\",\"ts\":" << std::fixed << std::setprecision(3) << us
+                    << ",\"pid\":1,\"tid\":" << tid;
+                if (r.phase == 'i') out << ",\"s\":\"t\"";
+                if (r.arg) out << ",\"args\":{\"arg\":" << r.arg << '}';
+                out << '}';
+                firstEvent = false;
+            }
+
+            std::atomic<bool> on{ false };
+
+            std::mutex buffersM;
+            std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+            std::mutex controlM;                // start and stop
+            std::mutex drainM;
+            std::condition_variable drainCv;
+            bool running = false;
+            std::thread drainer;
+
+            std::ofstream out;                  // the drain's, or stop's once it's joined
+            bool firstEvent = true;
+            std::uint64_t tickOrigin = 0;
+            double usPerTick = 0.001;
+        };
+
+        // names must be string literals (or other arrays with static storage
+        // duration): only their address is recorded
+        template<std::size_t N>
+        void instant(const char (&name)[N], std::uint64_t arg = 0) {
+            Tracer::instance().record('i', name, arg);
+        }
+
+        // a begin event now and the matching end event when the Scope goes
+        class Scope {
+        public:
+            template<std::size_t N>
+            explicit Scope(const char (&name)[N], std::uint64_t arg = 0) : name(name) {
+                Tracer::instance().record('B', name, arg);
+            }
+
+            ~Scope() { Tracer::instance().record('E', name, 0); }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            const char* name;
+        };
+    }
+
     void process(const Widget& ) {
         std::cout << "Called lvalue process" << std::endl;
     }; // process lvalues
@@ -86,18 +446,94 @@ namespace item23 {
     void logAndProcess(T&& param) {
         //auto now = std::chrono::system_clock::now();  // get current time
         // makeLogEntry("Calling 'process'", now);
+        trace::Scope traced("Calling 'process'");
 
         // std::forward is a conditional cast: it casts to an rvalue only if its argument
         // was initialized with an rvalue.
         process(std::forward<T>(param));
     }
 
+    // what an event costs the thread that records it, with tracing on or off.
+    // Events go in bursts a ring can hold, with pauses for the drain to catch
+    // up, so that an enabled run times pushes rather than drops.
+    void benchmarkTracing() {
+        constexpr int bursts = 32;
+        constexpr int perBurst = trace::ThreadBuffer::capacity / 2;
+
+        auto& tracer = trace::Tracer::instance();
+        std::chrono::steady_clock::duration busy{};
+        for (int b = 0; b != bursts; ++b) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i != perBurst; ++i) trace::instant("benchmark", i);
+            busy += std::chrono::steady_clock::now() - start;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        auto ns = std::chrono::duration<double, std::nano>(busy).count() / (bursts * perBurst);
+
+        // most of that is reading the clock, which on some virtual machines
+        // is far slower than on bare metal
+        volatile std::uint64_t last = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i != bursts * perBurst; ++i) last = trace::ticks();
+        (void)last;
+        auto clockNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+                       / (bursts * perBurst);
+
+        if (tracer.enabled()) {
+            std::cout << "enabled: " << ns << " ns/event (clock " << clockNs << " ns), "
+                      << tracer.dropped() << " dropped" << std::endl;
+        } else {
+            std::cout << "disabled: " << ns << " ns/event (run with --trace <file> to record)" << std::endl;
+        }
+    }
+
+    // Growing a vector of Widgets from empty, without reserve(): time per
+    // element for std::vector, which moves every Widget each time it grows,
+    // and RelocatingVector, which reallocs them where this library's
+    // std::string allows (with libstdc++, it doesn't, and RelocatingVector
+    // moves them too). Pointers to Widgets can always be relocated, so the
+    // std::unique_ptr<Widget> pair times the relocation path on any library.
+    template<typename Vector, typename Make>
+    double growNsPerElement(std::size_t n, Make make) {
+        Vector v;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i != n; ++i) v.emplace_back(make(i));
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+    }
+
+    void benchmarkGrowth() {
+        constexpr std::size_t n = 1'000'000;
+        auto widget = [](std::size_t i) { return Widget("a name that won't fit in the SSO buffer " + std::to_string(i)); };
+        auto pointer = [&](std::size_t i) { return std::make_unique<Widget>(widget(i)); };
+
+        std::cout << "growing to " << n << " elements" << '\n';
+        std::cout << "  std::vector<Widget>:                       "
+                  << growNsPerElement<std::vector<Widget>>(n, widget) << " ns/element" << '\n';
+        std::cout << "  RelocatingVector<Widget>:                  "
+                  << growNsPerElement<RelocatingVector<Widget>>(n, widget) << " ns/element"
+                  << (RelocatingVector<Widget>::relocates
+                          ? " (relocated)"
+                          : " (moved: this library's std::string isn't relocatable)") << '\n';
+        std::cout << "  std::vector<std::unique_ptr<Widget>>:      "
+                  << growNsPerElement<std::vector<std::unique_ptr<Widget>>>(n, pointer) << " ns/element" << '\n';
+        std::cout << "  RelocatingVector<std::unique_ptr<Widget>>: "
+                  << growNsPerElement<RelocatingVector<std::unique_ptr<Widget>>>(n, pointer) << " ns/element"
+                  << " (relocated)" << '\n';
+    }
+
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
     using namespace item23;
 
+    // tracing is opt in: item23 --trace <file> writes the run's events to file
+    const char* tracePath = argc > 2 && std::strcmp(argv[1], "--trace") == 0 ? argv[2] : nullptr;
+    if (tracePath && !trace::Tracer::instance().start(tracePath)) {
+        std::cerr << "can't open " << tracePath << '\n';
+        return 1;
+    }
+
     auto s = std::string("a");
     Widget w(s);
     logAndProcess(w);
@@ -106,5 +542,11 @@ int main() {
     std::cout << s << std::endl;
     std::cout << w.gets() << std::endl;
 
+    // with --trace, everything above was traced too; open the file in a trace viewer
+    benchmarkTracing();
+    trace::Tracer::instance().stop();
+
+    benchmarkGrowth();
+
     return 0;
 }
@@ -66,7 +66,7 @@ namespace item23 {
     class Widget {
     public:
         //Widget(Widget&& rhs) : s(std::move(rhs.s)) {
-        Widget(Widget&& rhs) : s(std::forward<std::string>(rhs.s)) {
+        Widget(Widget&& rhs) noexcept : s(std::forward<std::string>(rhs.s)) {
             ++moveCtorCalls;
         }
 
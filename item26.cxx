@@ -1,6 +1,30 @@
 #include <iostream>
 #include <set>
 #include <memory>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iterator>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define ITEM23_RDTSC 1
+#endif
 
 
 // ITEM 26: Avoid overloading on unversial references.
@@ -74,7 +98,7 @@ namespace item23 {
     class Widget {
     public:
         //Widget(Widget&& rhs) : s(std::move(rhs.s)) {
-        Widget(Widget&& rhs) : s(std::forward<std::string>(rhs.s)) {
+        Widget(Widget&& rhs) noexcept : s(std::forward<std::string>(rhs.s)) {
             ++moveCtorCalls;
         }
 
@@ -88,6 +112,228 @@ namespace item23 {
         std::string s;
     };
 
+    // makeLogEntry would format and write a line on every forwarded call. The
+    // tracer below does neither on the calling thread: an event is a 32-byte
+    // binary record (a timestamp, the event's name, one argument) pushed onto a
+    // ring buffer owned by the thread, and a background thread drains the rings
+    // into a file that chrome://tracing or Perfetto can open. Names are string
+    // literals recorded by address, so interning them costs nothing at run
+    // time; only the drain looks at the characters. Timestamps are the CPU's
+    // time-stamp counter where there is one, converted to microseconds when
+    // written. A full ring drops events (and counts them) rather than block.
+    namespace trace {
+        struct Record {
+            std::uint64_t ticks;
+            const char* name;
+            std::uint64_t arg;
+            char phase;                 // 'B'egin, 'E'nd or 'i'nstant
+        };
+
+        inline std::uint64_t ticks() noexcept {
+#ifdef ITEM23_RDTSC
+            return __rdtsc();
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        // single producer (the owning thread), single consumer (the drain)
+        class ThreadBuffer {
+        public:
+            static constexpr std::size_t capacity = 4096;
+
+            explicit ThreadBuffer(std::uint32_t tid) : tid(tid), records(new Record[capacity]) {}
+
+            bool tryPush(const Record& r) noexcept {
+                auto h = head.load(std::memory_order_relaxed);
+                if (h - cachedTail == capacity) {
+                    cachedTail = tail.load(std::memory_order_acquire);
+                    if (h - cachedTail == capacity) {
+                        dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                        return false;
+                    }
+                }
+                records[h & (capacity - 1)] = r;
+                head.store(h + 1, std::memory_order_release);
+                return true;
+            }
+
+            template<typename F>
+            void drain(F&& f) {
+                auto t = tail.load(std::memory_order_relaxed);
+                const auto h = head.load(std::memory_order_acquire);
+                for (; t != h; ++t) f(records[t & (capacity - 1)]);
+                tail.store(t, std::memory_order_release);
+            }
+
+            const std::uint32_t tid;
+            std::atomic<std::uint64_t> dropped{ 0 };
+
+        private:
+            std::unique_ptr<Record[]> records;
+            alignas(64) std::atomic<std::uint64_t> head{ 0 };
+            std::uint64_t cachedTail = 0;                       // producer's copy
+            alignas(64) std::atomic<std::uint64_t> tail{ 0 };
+        };
+
+        class Tracer {
+        public:
+            static Tracer& instance() {
+                static Tracer* t = new Tracer;      // never destroyed: threads may
+                return *t;                          // still trace during exit
+            }
+
+            bool enabled() const noexcept { return on.load(std::memory_order_relaxed); }
+
+            void record(char phase, const char* name, std::uint64_t arg) {
+                if (!enabled()) return;
+                threadBuffer().tryPush({ ticks(), name, arg, phase });
+            }
+
+            // begin writing events to path; false if it can't be opened
+            bool start(const std::string& path) {
+                std::lock_guard<std::mutex> g(controlM);
+                if (drainer.joinable()) return false;
+
+                out.open(path, std::ios::trunc);
+                if (!out) return false;
+                out << "[";
+                firstEvent = true;
+                calibrate();
+
+                running = true;
+                drainer = std::thread([this] { drainLoop(); });
+                on.store(true, std::memory_order_relaxed);
+                return true;
+            }
+
+            // stop recording, write out whatever's left and close the file
+            void stop() {
+                std::lock_guard<std::mutex> g(controlM);
+                if (!drainer.joinable()) return;
+
+                on.store(false, std::memory_order_relaxed);
+                {
+                    std::lock_guard<std::mutex> lk(drainM);
+                    running = false;
+                }
+                drainCv.notify_one();
+                drainer.join();
+
+                drainAll();
+                out << "\n]\n";
+                out.close();
+            }
+
+            std::uint64_t dropped() {
+                std::lock_guard<std::mutex> g(buffersM);
+                std::uint64_t n = 0;
+                for (auto& b : buffers) n += b->dropped.load(std::memory_order_relaxed);
+                return n;
+            }
+
+        private:
+            Tracer() = default;
+
+            ThreadBuffer& threadBuffer() {
+                thread_local ThreadBuffer* mine = nullptr;
+                if (!mine) {
+                    std::lock_guard<std::mutex> g(buffersM);
+                    buffers.push_back(std::make_unique<ThreadBuffer>(static_cast<std::uint32_t>(buffers.size() + 1)));
+                    mine = buffers.back().get();     // owned here, so events a thread
+                }                                    // leaves behind still get written
+                return *mine;
+            }
+
+            // microseconds per tick, measured over a few milliseconds
+            void calibrate() {
+                auto steady0 = std::chrono::steady_clock::now();
+                auto ticks0 = ticks();
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                auto elapsed = std::chrono::steady_clock::now() - steady0;
+                auto elapsedTicks = ticks() - ticks0;
+                usPerTick = std::chrono::duration<double, std::micro>(elapsed).count() /
+                            static_cast<double>(elapsedTicks ? elapsedTicks : 1);
+                tickOrigin = ticks0;
+            }
+
+            void drainLoop() {
+                std::unique_lock<std::mutex> lk(drainM);
+                while (running) {
+                    drainCv.wait_for(lk, std::chrono::milliseconds(2));
+                    lk.unlock();
+                    drainAll();
+                    lk.lock();
+                }
+            }
+
+            void drainAll() {
+                std::lock_guard<std::mutex> g(buffersM);
+                for (auto& b : buffers) {
+                    b->drain([&](const Record& r) { write(r, b->tid); });
+                }
+                out.flush();
+            }
+
+            void write(const Record& r, std::uint32_t tid) {
+                auto us = static_cast<double>(static_cast<std::int64_t>(r.ticks - tickOrigin)) * usPerTick;
+
+                out << (firstEvent ? "\n" : ",\n") << "{\"name\":\"";
+                for (auto p = r.name; *p; ++p) {
+                    if (*p == '"' || *p == '\\') out << '\\';
+                    out << *p;
+                }
+                out << "\",\"ph\":\"" << r.phase << "\",\"ts\":" << std::fixed << std::setprecision(3) << us
+                    << ",\"pid\":1,\"tid\":" << tid;
+                if (r.phase == 'i') out << ",\"s\":\"t\"";
+                if (r.arg) out << ",\"args\":{\"arg\":" << r.arg << '}';
+                out << '}';
+                firstEvent = false;
+            }
+
+            std::atomic<bool> on{ false };
+
+            std::mutex buffersM;
+            std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+            std::mutex controlM;                // start and stop
+            std::mutex drainM;
+            std::condition_variable drainCv;
+            bool running = false;
+            std::thread drainer;
+
+            std::ofstream out;                  // the drain's, or stop's once it's joined
+            bool firstEvent = true;
+            std::uint64_t tickOrigin = 0;
+            double usPerTick = 0.001;
+        };
+
+        // names must be string literals (or other arrays with static storage
+        // duration): only their address is recorded
+        template<std::size_t N>
+        void instant(const char (&name)[N], std::uint64_t arg = 0) {
+            Tracer::instance().record('i', name, arg);
+        }
+
+        // a begin event now and the matching end event when the Scope goes
+        class Scope {
+        public:
+            template<std::size_t N>
+            explicit Scope(const char (&name)[N], std::uint64_t arg = 0) : name(name) {
+                Tracer::instance().record('B', name, arg);
+            }
+
+            ~Scope() { Tracer::instance().record('E', name, 0); }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            const char* name;
+        };
+    }
+
     void process(const Widget& ) {
         std::cout << "Called lvalue process" << std::endl;
     }; // process lvalues
@@ -100,6 +346,7 @@ namespace item23 {
     void logAndProcess(T&& param) {
         //auto now = std::chrono::system_clock::now();  // get current time
         // makeLogEntry("Calling 'process'", now);
+        trace::Scope traced("Calling 'process'");
 
         // std::forward is a conditional cast: it casts to an rvalue only if its argument
         // was initialized with an rvalue.
@@ -164,7 +411,7 @@ namespace item25 {
     class Widget {
     public:
         // rhs is a rvalue reference
-        Widget(Widget&& rhs) : name(std::move(rhs.name)), p(std::move(rhs.p)) {};
+        Widget(Widget&& rhs) noexcept : name(std::move(rhs.name)), p(std::move(rhs.p)) {};
 
         template<typename T>
         void setName(T&& newName) {
@@ -187,13 +434,39 @@ namespace item25 {
     }
 }
 
+// every heap allocation, so the lookup benchmark can show which lookups allocate
+namespace accounting {
+    std::atomic<std::size_t> allocations{ 0 };
+}
+
+void* operator new(std::size_t size) {
+    accounting::allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+// GCC pairs the std::free here with the std::malloc in operator new only while
+// operator delete does nothing else, and otherwise flags every inlined
+// deallocation as mismatched
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { ::operator delete(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
 namespace item26 {
-    std::multiset<std::string> names;   // global data structure
+    using NameSet = std::multiset<std::string, std::less<>>;
+    NameSet names;   // global data structure
 
     template<typename T>
     void logAndAdd(T&& name) {
         std::cout << "Universal logAnddAdd Called" << std::endl;
         //auto now = std::chrono::system_clock::now(); // get current time
+        item23::trace::Scope traced("logAndAdd");
         names.emplace(std::forward<T>(name));        // add name to global data structure; see Item42 for info on emplace
     }
 
@@ -206,15 +479,202 @@ namespace item26 {
     void logAndAdd(int idx) {
         std::cout << "Int logAndAdd Called" << std::endl;
         //auto now = std::chrono::system_clock::now(); // get current time
+        item23::trace::Scope traced("logAndAdd(int)", static_cast<std::uint64_t>(idx));
         names.emplace(nameFromIdx(idx));
     }
 
 
+    // std::endl flushes the stream, so logging every insert costs a flush (and
+    // with std::cout, typically a write syscall) per name. The batch API logs to
+    // a sink that collects lines in memory and hands them to the stream only
+    // when capacity bytes have piled up, or on flush().
+    class BufferedLogSink {
+    public:
+        explicit BufferedLogSink(std::ostream& os, std::size_t capacity = 64 * 1024)
+            : out(os), capacity(capacity) { buffer.reserve(capacity); }
+
+        ~BufferedLogSink() { flush(); }
+
+        BufferedLogSink(const BufferedLogSink&) = delete;
+        BufferedLogSink& operator=(const BufferedLogSink&) = delete;
+
+        void write(std::string_view line) {
+            buffer.append(line.data(), line.size());
+            buffer.push_back('\n');
+            if (buffer.size() >= capacity) flush();
+        }
+
+        void flush() {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            out.flush();
+            buffer.clear();
+        }
+
+    private:
+        std::ostream& out;
+        std::size_t capacity;
+        std::string buffer;
+    };
+
+    BufferedLogSink& logSink() {
+        static BufferedLogSink sink(std::cout);
+        return sink;
+    }
+
+    // Add a whole range of names, or of name indices, at once. The batch is
+    // materialised into one reserved vector and sorted, then merged into names
+    // in order: each node goes in right next to the previous one, so the hint
+    // is almost always right and the insertion is amortized O(1) instead of a
+    // full O(log n) descent. Indices are resolved with nameFromIdx once per
+    // distinct index, and the whole batch is logged as one line to logSink.
+    //
+    // The element type is dispatched on once per batch, not once per name.
+    // non-integral elements: names, as anything std::string can be built from
+    template<typename Range>
+    std::vector<std::string> sortedBatchImpl(const Range& range, std::false_type) {
+        std::vector<std::string> batch;
+        batch.reserve(static_cast<std::size_t>(std::distance(std::begin(range), std::end(range))));
+        for (auto&& name : range) batch.emplace_back(name);
+        return batch;
+    }
+
+    // integral elements: indices, each distinct one looked up via nameFromIdx once
+    template<typename Range>
+    std::vector<std::string> sortedBatchImpl(const Range& range, std::true_type) {
+        using IdxT = std::decay_t<decltype(*std::begin(range))>;
+
+        std::vector<IdxT> idxs(std::begin(range), std::end(range));
+        std::sort(idxs.begin(), idxs.end());
+
+        std::vector<std::string> batch;
+        batch.reserve(idxs.size());
+        for (std::size_t i = 0; i < idxs.size(); ++i) {
+            if (i == 0 || idxs[i] != idxs[i - 1]) batch.push_back(nameFromIdx(idxs[i]));
+            else batch.push_back(batch.back());
+        }
+        return batch;
+    }
+
+    template<typename Range>
+    std::vector<std::string> sortedBatch(const Range& range) {
+        using ElemT = std::decay_t<decltype(*std::begin(range))>;
+        auto batch = sortedBatchImpl(range, std::is_integral<ElemT>());
+        std::sort(batch.begin(), batch.end());
+        return batch;
+    }
+
+    // batch is sorted; its names are moved into set
+    template<typename Set>
+    void mergeSorted(Set& set, std::vector<std::string>& batch) {
+        if (batch.empty()) return;
+
+        auto hint = set.lower_bound(batch.front());
+        for (auto& name : batch) {
+            hint = std::next(set.emplace_hint(hint, std::move(name)));
+        }
+    }
+
+    template<typename Range>
+    void logAndAddBatch(const Range& range) {
+        auto batch = sortedBatch(range);
+        if (batch.empty()) return;
+
+        mergeSorted(names, batch);
+        logSink().write("Batch logAndAdd Called: " + std::to_string(batch.size()) + " names");
+    }
+
+    // names uses std::less<> (a transparent comparator), so find, count,
+    // lower_bound and equal_range accept a std::string_view or a const char*
+    // directly and compare against the stored strings in place. With the
+    // default std::less<std::string>, every such lookup would first build a
+    // temporary std::string, which allocates for names too long for the small
+    // string buffer.
+    using NameRange = std::pair<NameSet::const_iterator, NameSet::const_iterator>;
+
+    std::size_t countName(std::string_view name) {
+        return names.count(name);
+    }
+
+    // one equal_range per key, in the same order as keys; no allocation beyond
+    // the result vector
+    template<typename Range>
+    std::vector<NameRange> equalRanges(const Range& keys) {
+        std::vector<NameRange> result;
+        result.reserve(static_cast<std::size_t>(std::distance(std::begin(keys), std::end(keys))));
+        for (auto&& key : keys) {
+            result.push_back(names.equal_range(std::string_view(key)));
+        }
+        return result;
+    }
+
+    template<typename Range>
+    std::vector<std::size_t> countNames(const Range& keys) {
+        std::vector<std::size_t> result;
+        result.reserve(static_cast<std::size_t>(std::distance(std::begin(keys), std::end(keys))));
+        for (auto& r : equalRanges(keys)) {
+            result.push_back(static_cast<std::size_t>(std::distance(r.first, r.second)));
+        }
+        return result;
+    }
+
+    // const char* lookups against the default comparator versus std::less<>.
+    // For the transparent set the key is turned into a std::string_view once up
+    // front; comparing against a raw const char* would redo strlen every time.
+    struct LookupCost {
+        double nsPerOp;
+        double allocationsPerOp;
+    };
+
+    template<typename Set, typename ToKey>
+    LookupCost lookupCost(const Set& set, const std::vector<const char*>& keys, int rounds, ToKey toKey) {
+        std::size_t found = 0;
+        const auto allocationsBefore = accounting::allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        for (auto r = 0; r < rounds; ++r) {
+            for (auto key : keys) found += set.count(toKey(key));
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        const auto allocations = accounting::allocations.load(std::memory_order_relaxed) - allocationsBefore;
+
+        if (found == 0) std::cout << "(nothing found)" << '\n';
+        const auto lookups = static_cast<double>(rounds) * keys.size();
+        return { elapsed.count() / lookups, allocations / lookups };
+    }
+
+    void benchmarkLookups() {
+        std::vector<std::string> pool;
+        for (auto i = 0; i < 10'000; ++i) {     // longer than the SSO buffer
+            pool.push_back("a rather long pet name, number " + std::to_string(i));
+        }
+
+        std::multiset<std::string> byDefault(pool.begin(), pool.end());
+        NameSet transparent(pool.begin(), pool.end());
+
+        std::vector<const char*> keys;
+        for (std::size_t i = 0; i < pool.size(); i += 7) keys.push_back(pool[i].c_str());
+
+        // the default set can only look up a std::string, the transparent one takes a view
+        auto asString = [](const char* key) { return std::string(key); };
+        auto asView = [](const char* key) { return std::string_view(key); };
+
+        auto report = [](const char* what, LookupCost cost) {
+            std::cout << what << cost.nsPerOp << " ns/lookup, "
+                      << cost.allocationsPerOp << " allocations/lookup" << '\n';
+        };
+        report("std::less<std::string>: ", lookupCost(byDefault, keys, 100, asString));
+        report("std::less<>:            ", lookupCost(transparent, keys, 100, asView));
+    }
+
+
     class Person {
     public:
         template<typename T>
         explicit Person(T&& n): // perfect forwarding ctor;
+#ifdef SHOW_COMPILE_ERRORS
             name(std::forward<Person&>(n)) { std::cout << "univeral called" << std::endl; };
+#else
+            name(std::forward<T>(n)) { std::cout << "univeral called" << std::endl; };
+#endif
 
         explicit Person(int idx): // int ctor
            name(nameFromIdx(idx)) { std::cout << "int called" << std::endl; }; // int ctor
@@ -228,6 +688,10 @@ namespace item26 {
         std::string name;
     };
 
+    // the Item's point: neither of these compiles, since both pick Person's
+    // forwarding ctor, which then tries to build a std::string from a
+    // SpecialPerson. Build with -DSHOW_COMPILE_ERRORS to see it.
+#ifdef SHOW_COMPILE_ERRORS
     class SpecialPerson: public Person {
     public:
         SpecialPerson(const SpecialPerson& rhs): Person(rhs) {}  // copy ctor; calls
@@ -237,12 +701,21 @@ namespace item26 {
                                                                       // base class
                                                                       // forwarding ctor!
     };
+#endif
 
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
     using namespace item26;
+
+    // tracing is opt in: item26 --trace <file> writes the run's events to file
+    const char* tracePath = argc > 2 && std::strcmp(argv[1], "--trace") == 0 ? argv[2] : nullptr;
+    if (tracePath && !item23::trace::Tracer::instance().start(tracePath)) {
+        std::cerr << "can't open " << tracePath << '\n';
+        return 1;
+    }
+
     std::string petName("Darla");
 
 
@@ -253,6 +726,15 @@ int main() {
 
     logAndAdd(22); // calls int overload
 
+    // many names at once: one sorted merge, one buffered log line
+    std::vector<std::string> morePets{ "Rex", "Fido", "Rex" };
+    logAndAddBatch(morePets);
+    logAndAddBatch(std::vector<int>{ 3, 1, 3 });
+
+    // looked up as const char*, without building a std::string
+    std::cout << countName("Rex") << " Rex, " << countNames(std::vector<const char*>{ "Fido", "Darla" })[1] << " Darla" << '\n';
+    benchmarkLookups();
+
     //short nameIdx = 1;
     //logAndAdd(nameIdx); // error!
 
@@ -267,6 +749,8 @@ int main() {
     const Person cp("Nancy");
     auto cloneofP(cp); // calls copy constructor!
 
+    item23::trace::Tracer::instance().stop();
+
 
   return 0;
 }
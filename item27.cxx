@@ -1,6 +1,17 @@
 #include <iostream>
 #include <set>
 #include <memory>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 
 // ITEM 27: Familiarize yourself with alternatives to overloading on universal references.
@@ -74,7 +85,7 @@ namespace item23 {
     class Widget {
     public:
         //Widget(Widget&& rhs) : s(std::move(rhs.s)) {
-        Widget(Widget&& rhs) : s(std::forward<std::string>(rhs.s)) {
+        Widget(Widget&& rhs) noexcept : s(std::forward<std::string>(rhs.s)) {
             ++moveCtorCalls;
         }
 
@@ -164,7 +175,7 @@ namespace item25 {
     class Widget {
     public:
         // rhs is a rvalue reference
-        Widget(Widget&& rhs) : name(std::move(rhs.name)), p(std::move(rhs.p)) {};
+        Widget(Widget&& rhs) noexcept : name(std::move(rhs.name)), p(std::move(rhs.p)) {};
 
         template<typename T>
         void setName(T&& newName) {
@@ -210,6 +221,97 @@ namespace item26 {
     }
 
 
+    // std::endl flushes the stream, so logging every insert costs a flush (and
+    // with std::cout, typically a write syscall) per name. The batch API logs to
+    // a sink that collects lines in memory and hands them to the stream only
+    // when capacity bytes have piled up, or on flush().
+    class BufferedLogSink {
+    public:
+        explicit BufferedLogSink(std::ostream& os, std::size_t capacity = 64 * 1024)
+            : out(os), capacity(capacity) { buffer.reserve(capacity); }
+
+        ~BufferedLogSink() { flush(); }
+
+        BufferedLogSink(const BufferedLogSink&) = delete;
+        BufferedLogSink& operator=(const BufferedLogSink&) = delete;
+
+        void write(std::string_view line) {
+            buffer.append(line.data(), line.size());
+            buffer.push_back('\n');
+            if (buffer.size() >= capacity) flush();
+        }
+
+        void flush() {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            out.flush();
+            buffer.clear();
+        }
+
+    private:
+        std::ostream& out;
+        std::size_t capacity;
+        std::string buffer;
+    };
+
+    BufferedLogSink& logSink() {
+        static BufferedLogSink sink(std::cout);
+        return sink;
+    }
+
+    // Add a whole range of names, or of name indices, at once. The batch is
+    // materialised into one reserved vector and sorted, then merged into names
+    // in order: each node goes in right next to the previous one, so the hint
+    // is almost always right and the insertion is amortized O(1) instead of a
+    // full O(log n) descent. Indices are resolved with nameFromIdx once per
+    // distinct index, and the whole batch is logged as one line to logSink.
+    //
+    // The element type is dispatched on once per batch, not once per name.
+    // non-integral elements: names, as anything std::string can be built from
+    template<typename Range>
+    std::vector<std::string> sortedBatchImpl(const Range& range, std::false_type) {
+        std::vector<std::string> batch;
+        batch.reserve(static_cast<std::size_t>(std::distance(std::begin(range), std::end(range))));
+        for (auto&& name : range) batch.emplace_back(name);
+        return batch;
+    }
+
+    // integral elements: indices, each distinct one looked up via nameFromIdx once
+    template<typename Range>
+    std::vector<std::string> sortedBatchImpl(const Range& range, std::true_type) {
+        using IdxT = std::decay_t<decltype(*std::begin(range))>;
+
+        std::vector<IdxT> idxs(std::begin(range), std::end(range));
+        std::sort(idxs.begin(), idxs.end());
+
+        std::vector<std::string> batch;
+        batch.reserve(idxs.size());
+        for (std::size_t i = 0; i < idxs.size(); ++i) {
+            if (i == 0 || idxs[i] != idxs[i - 1]) batch.push_back(nameFromIdx(idxs[i]));
+            else batch.push_back(batch.back());
+        }
+        return batch;
+    }
+
+    template<typename Range>
+    std::vector<std::string> sortedBatch(const Range& range) {
+        using ElemT = std::decay_t<decltype(*std::begin(range))>;
+        auto batch = sortedBatchImpl(range, std::is_integral<ElemT>());
+        std::sort(batch.begin(), batch.end());
+        return batch;
+    }
+
+    // batch is sorted; its names are moved into set
+    template<typename Set>
+    void mergeSorted(Set& set, std::vector<std::string>& batch) {
+        if (batch.empty()) return;
+
+        auto hint = set.lower_bound(batch.front());
+        for (auto& name : batch) {
+            hint = std::next(set.emplace_hint(hint, std::move(name)));
+        }
+    }
+
+
     class Person {
     public:
         template<typename T>
@@ -228,6 +330,10 @@ namespace item26 {
         std::string name;
     };
 
+    // the Item's point: neither of these compiles, since both pick Person's
+    // forwarding ctor, which then tries to build a std::string from a
+    // SpecialPerson. Build with -DSHOW_COMPILE_ERRORS to see it.
+#ifdef SHOW_COMPILE_ERRORS
     class SpecialPerson: public Person {
     public:
         SpecialPerson(const SpecialPerson& rhs): Person(rhs) {}  // copy ctor; calls
@@ -237,6 +343,7 @@ namespace item26 {
                                                                       // base class
                                                                       // forwarding ctor!
     };
+#endif
 }
 
 
@@ -259,6 +366,8 @@ namespace item27 {
     std::multiset<std::string> names;
 
 
+    void logAndAddImpl(int idx, std::true_type);  // integral argument, defined below
+
     // non-integral argument: add it to global data structure.
     template<typename T>
     void logAndAddImpl(T&& name, std::false_type) {
@@ -273,13 +382,25 @@ namespace item27 {
         //logAndAddImpl(std::forward<T>(name), std::is_integral<typename std::remove_reference<T>::type>());
 
         // C++ 14
-        logAndAddImpl(std::forward<T>(name), std::is_integral<std::remove_reference<T>>());
+        logAndAddImpl(std::forward<T>(name), std::is_integral<std::remove_reference_t<T>>());
     }
 
     void logAndAddImpl(int idx, std::true_type) {
         logAndAdd(nameFromIdx(idx));
     }
 
+    // Batched version: item26's sorted batch, which dispatches on the element
+    // type once per batch, merged into this Item's names and logged as one
+    // line to the buffered sink
+    template<typename Range>
+    void logAndAddBatch(const Range& range) {
+        auto batch = item26::sortedBatch(range);
+        if (batch.empty()) return;
+
+        item26::mergeSorted(names, batch);
+        item26::logSink().write("Batch logAndAdd Called: " + std::to_string(batch.size()) + " names");
+    }
+
     // Constraining templates that take universal references
     class Person {
     public:
@@ -298,10 +419,177 @@ namespace item27 {
     private:
         std::string name;
     };
+
+    // Every Person above owns its own std::string, so a million Persons built
+    // from a handful of names hold a million copies of them. StringPool
+    // interns names instead: each distinct name is stored once, in arena
+    // chunks owned by the pool, and everybody holding that name holds an
+    // InternedString, a single pointer into the pool. Since equal names share
+    // storage, they compare equal by pointer.
+    //
+    // The pool is split into shards by hash, each with its own
+    // std::shared_mutex; looking up a name that's already interned takes only a
+    // shared lock. Interned strings live as long as the pool.
+    class InternedString {
+    public:
+        InternedString() noexcept = default;
+
+        std::string_view view() const noexcept {
+            if (!p) return {};
+            std::size_t len;
+            std::memcpy(&len, p, sizeof(len));
+            return { p + sizeof(len), len };
+        }
+        const char* c_str() const noexcept { return p ? p + sizeof(std::size_t) : ""; }
+
+        friend bool operator==(InternedString lhs, InternedString rhs) noexcept { return lhs.p == rhs.p; }
+        friend bool operator!=(InternedString lhs, InternedString rhs) noexcept { return lhs.p != rhs.p; }
+
+    private:
+        friend class StringPool;
+        explicit InternedString(const char* entry) noexcept : p(entry) {}
+
+        const char* p = nullptr;    // length, then the characters and a '\0'
+    };
+
+    class StringPool {
+    public:
+        InternedString intern(std::string_view s) {
+            auto& shard = shards[std::hash<std::string_view>{}(s) & (numShards - 1)];
+
+            {
+                std::shared_lock<std::shared_mutex> g(shard.m);
+                auto it = shard.entries.find(s);
+                if (it != shard.entries.end()) return InternedString(it->second);
+            }
+
+            std::lock_guard<std::shared_mutex> g(shard.m);
+            auto it = shard.entries.find(s);
+            if (it != shard.entries.end()) return InternedString(it->second);
+
+            auto entry = shard.store(s);
+            shard.entries.emplace(std::string_view(entry + sizeof(std::size_t), s.size()), entry);
+            return InternedString(entry);
+        }
+
+        static StringPool& global() {
+            static StringPool pool;
+            return pool;
+        }
+
+    private:
+        static constexpr std::size_t numShards = 16;
+        static constexpr std::size_t chunkSize = 64 * 1024;
+
+        struct alignas(64) Shard {
+            const char* store(std::string_view s) {     // copy s into the arena
+                auto bytes = sizeof(std::size_t) + s.size() + 1;
+                bytes = (bytes + alignof(std::size_t) - 1) & ~(alignof(std::size_t) - 1);
+
+                if (bytes > static_cast<std::size_t>(end - cur)) {
+                    auto size = std::max(chunkSize, bytes);
+                    chunks.emplace_back(new char[size]);
+                    cur = chunks.back().get();
+                    end = cur + size;
+                }
+
+                auto entry = cur;
+                auto len = s.size();
+                std::memcpy(entry, &len, sizeof(len));
+                std::memcpy(entry + sizeof(len), s.data(), len);
+                entry[sizeof(len) + len] = '\0';
+                cur += bytes;
+                return entry;
+            }
+
+            std::shared_mutex m;
+            std::unordered_map<std::string_view, const char*> entries;  // views point
+            std::vector<std::unique_ptr<char[]>> chunks;                // into chunks
+            char* cur = nullptr;
+            char* end = nullptr;
+        };
+
+        Shard shards[numShards];
+    };
+
+    // Person and Person_PBV again, holding interned names
+    class InternedPerson {
+    public:
+        // builds a std::string_view from n (no std::string, so no allocation,
+        // even for a string literal) and looks that up in the pool
+        template<typename T,
+                 typename = std::enable_if_t<
+                     !std::is_base_of<InternedPerson, std::decay_t<T>>::value &&
+                     !std::is_integral<std::remove_reference_t<T>>::value &&
+                     std::is_constructible<std::string_view, const T&>::value>>
+        explicit InternedPerson(T&& n)
+            : name(StringPool::global().intern(std::string_view(n))) {}
+
+        explicit InternedPerson(int idx)
+            : name(StringPool::global().intern(nameFromIdx(idx))) {}
+
+        std::string_view getName() const noexcept { return name.view(); }
+
+        bool sameName(const InternedPerson& rhs) const noexcept { return name == rhs.name; }
+
+    private:
+        InternedString name;
+    };
+
+    class InternedPerson_PBV {
+    public:
+        explicit InternedPerson_PBV(std::string_view n)     // a view is cheap to
+            : name(StringPool::global().intern(n)) {}       // pass by value
+
+        explicit InternedPerson_PBV(int idx)
+            : name(StringPool::global().intern(nameFromIdx(idx))) {}
+
+        std::string_view getName() const noexcept { return name.view(); }
+
+    private:
+        InternedString name;
+    };
 }
 
 
 
 int main() {
+   using namespace item27;
+
+   logAndAdd("Patty Dog");
+   logAndAdd(22);                  // tag dispatch: looked up via nameFromIdx
+
+   logAndAddBatch(std::vector<std::string>{ "Rex", "Fido" });
+   logAndAddBatch(std::vector<int>{ 3, 1, 3 });
+
+   // same name, same storage
+   InternedPerson p1("Nancy");
+   InternedPerson p2(std::string("Nancy"));
+   InternedPerson_PBV p3("Nancy");
+   std::cout << std::boolalpha << p1.sameName(p2) << ' '
+             << (p1.getName().data() == p3.getName().data()) << '\n';
+
+   // a million Persons from a handful of names, built on four threads at once:
+   // the pool stores each name once and every Person points at that copy
+   const char* const petNames[] = { "Darla", "Persephone", "Patty Dog", "a rather long pet name" };
+   std::vector<std::vector<InternedPerson>> people(4);
+   {
+       std::vector<std::thread> threads;
+       for (auto t = 0; t < 4; ++t) {
+           threads.emplace_back([&people, &petNames, t] {
+               people[t].reserve(250'000);
+               for (auto i = 0; i < 250'000; ++i) people[t].emplace_back(petNames[(i + t) % 4]);
+           });
+       }
+       for (auto& th : threads) th.join();
+   }
+
+   std::set<const char*> storage;
+   for (auto& ps : people) {
+       for (auto& person : ps) storage.insert(person.getName().data());
+   }
+   std::cout << people.size() * people[0].size() << " Persons, " << storage.size()
+             << " copies of their names" << '\n';
+
    return 0;
 }
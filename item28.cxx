@@ -76,7 +76,7 @@ namespace item23 {
     class Widget {
     public:
         //Widget(Widget&& rhs) : s(std::move(rhs.s)) {
-        Widget(Widget&& rhs) : s(std::forward<std::string>(rhs.s)) {
+        Widget(Widget&& rhs) noexcept : s(std::forward<std::string>(rhs.s)) {
             ++moveCtorCalls;
         }
 
@@ -166,7 +166,7 @@ namespace item25 {
     class Widget {
     public:
         // rhs is a rvalue reference
-        Widget(Widget&& rhs) : name(std::move(rhs.name)), p(std::move(rhs.p)) {};
+        Widget(Widget&& rhs) noexcept : name(std::move(rhs.name)), p(std::move(rhs.p)) {};
 
         template<typename T>
         void setName(T&& newName) {
@@ -230,6 +230,10 @@ namespace item26 {
         std::string name;
     };
 
+    // the Item's point: neither of these compiles, since both pick Person's
+    // forwarding ctor, which then tries to build a std::string from a
+    // SpecialPerson. Build with -DSHOW_COMPILE_ERRORS to see it.
+#ifdef SHOW_COMPILE_ERRORS
     class SpecialPerson: public Person {
     public:
         SpecialPerson(const SpecialPerson& rhs): Person(rhs) {}  // copy ctor; calls
@@ -239,6 +243,7 @@ namespace item26 {
                                                                       // base class
                                                                       // forwarding ctor!
     };
+#endif
 
 }
 
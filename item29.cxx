@@ -2,6 +2,13 @@
 #include <set>
 #include <vector>
 #include <memory>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 
 // ITEM 29: Assume that move operations are not present, not cheap, and not used.
@@ -71,7 +78,7 @@ namespace item23 {
     class Widget {
     public:
         //Widget(Widget&& rhs) : s(std::move(rhs.s)) {
-        Widget(Widget&& rhs) : s(std::forward<std::string>(rhs.s)) {
+        Widget(Widget&& rhs) noexcept : s(std::forward<std::string>(rhs.s)) {
             ++moveCtorCalls;
         }
 
@@ -161,7 +168,7 @@ namespace item25 {
     class Widget {
     public:
         // rhs is a rvalue reference
-        Widget(Widget&& rhs) : name(std::move(rhs.name)), p(std::move(rhs.p)) {};
+        Widget(Widget&& rhs) noexcept : name(std::move(rhs.name)), p(std::move(rhs.p)) {};
 
         template<typename T>
         void setName(T&& newName) {
@@ -225,6 +232,10 @@ namespace item26 {
         std::string name;
     };
 
+    // the Item's point: neither of these compiles, since both pick Person's
+    // forwarding ctor, which then tries to build a std::string from a
+    // SpecialPerson. Build with -DSHOW_COMPILE_ERRORS to see it.
+#ifdef SHOW_COMPILE_ERRORS
     class SpecialPerson: public Person {
     public:
         SpecialPerson(const SpecialPerson& rhs): Person(rhs) {}  // copy ctor; calls
@@ -234,6 +245,7 @@ namespace item26 {
                                                                       // base class
                                                                       // forwarding ctor!
     };
+#endif
 
 }
 
@@ -328,6 +340,9 @@ namespace item29 {
      *  the target, and set the source's pointer to null
      * */
 
+    // Widget is only declared, so none of this compiles as it stands; build
+    // with -DSHOW_COMPILE_ERRORS to try it
+#ifdef SHOW_COMPILE_ERRORS
     class Widget;
 
     // put data into vw1
@@ -346,9 +361,167 @@ namespace item29 {
 
     // move aw1 into aw2. Runs in linear time. All elements in aw1 are moved into aw2.
     auto aw2 = std::move(aw1);
+#endif
+
+
+    /*
+     *  FixedVector<T, N> is for when you want both: a capacity fixed at compile time, like
+     *  std::array, and a constant-time move, like std::vector. It allocates room for N elements
+     *  once, when it's constructed (through Alloc, so the room can come from a pool), and never
+     *  again; emplace_back constructs into that room and throws std::length_error once it's full.
+     *  A move hands the buffer over, leaving the source empty and without one; if the source is
+     *  used again, it allocates a fresh buffer on the first emplace_back.
+     * */
+    template<typename T, std::size_t N, typename Alloc = std::allocator<T>>
+    class FixedVector {
+        using Traits = std::allocator_traits<Alloc>;
+        static_assert(Traits::is_always_equal::value,
+                      "a moved buffer must be deallocatable by any allocator of this type");
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        static constexpr size_type capacity() noexcept { return N; }
+        static constexpr size_type max_size() noexcept { return N; }
+
+        FixedVector() : buffer(allocate()) {}
+
+        FixedVector(std::initializer_list<T> init) : FixedVector() {
+            if (init.size() > N) throw std::length_error("FixedVector: too many elements");
+            for (auto& x : init) emplace_back(x);
+        }
+
+        FixedVector(const FixedVector& rhs) : FixedVector() {
+            for (auto& x : rhs) emplace_back(x);
+        }
+
+        FixedVector(FixedVector&& rhs) noexcept
+            : buffer(std::exchange(rhs.buffer, nullptr)), count(std::exchange(rhs.count, 0)) {}
+
+        FixedVector& operator=(const FixedVector& rhs) {
+            if (this != &rhs) {
+                FixedVector tmp(rhs);
+                *this = std::move(tmp);
+            }
+            return *this;
+        }
+
+        FixedVector& operator=(FixedVector&& rhs) noexcept {
+            if (this != &rhs) {
+                release();
+                buffer = std::exchange(rhs.buffer, nullptr);
+                count = std::exchange(rhs.count, 0);
+            }
+            return *this;
+        }
+
+        ~FixedVector() { release(); }
+
+        template<typename... Ts>
+        T& emplace_back(Ts&&... params) {
+            if (count == N) throw std::length_error("FixedVector: full");
+            if (!buffer) buffer = allocate();           // reused after a move
+
+            Alloc alloc;
+            Traits::construct(alloc, buffer + count, std::forward<Ts>(params)...);
+            return buffer[count++];
+        }
+
+        void push_back(const T& x) { emplace_back(x); }
+        void push_back(T&& x) { emplace_back(std::move(x)); }
+
+        void pop_back() noexcept {
+            Alloc alloc;
+            Traits::destroy(alloc, buffer + --count);
+        }
+
+        void clear() noexcept {
+            while (count) pop_back();
+        }
+
+        size_type size() const noexcept { return count; }
+        bool empty() const noexcept { return count == 0; }
+        bool full() const noexcept { return count == N; }
+
+        T* data() noexcept { return buffer; }
+        const T* data() const noexcept { return buffer; }
+
+        T& operator[](size_type i) noexcept { return buffer[i]; }
+        const T& operator[](size_type i) const noexcept { return buffer[i]; }
+        T& front() noexcept { return buffer[0]; }
+        T& back() noexcept { return buffer[count - 1]; }
+
+        iterator begin() noexcept { return buffer; }
+        iterator end() noexcept { return buffer + count; }
+        const_iterator begin() const noexcept { return buffer; }
+        const_iterator end() const noexcept { return buffer + count; }
+
+    private:
+        static T* allocate() {
+            Alloc alloc;
+            return Traits::allocate(alloc, N);
+        }
+
+        void release() noexcept {
+            if (!buffer) return;
+            clear();
+            Alloc alloc;
+            Traits::deallocate(alloc, buffer, N);
+            buffer = nullptr;
+        }
+
+        T* buffer;
+        size_type count = 0;
+    };
+
+    static_assert(FixedVector<int, 10000>::capacity() == 10000, "capacity is a constant expression");
+    static_assert(sizeof(FixedVector<int, 10000>) == 2 * sizeof(void*), "just a pointer and a size");
+
+
+    // Moving 10000 elements back and forth, the item29 sizes: std::array moves every element,
+    // std::vector and FixedVector move a pointer.
+    template<typename Container, typename Fill>
+    double nsPerMove(Container& a, Fill fill, int moves) {
+        fill(a);
+        auto b = std::move(a);
+        auto start = std::chrono::steady_clock::now();
+        for (auto i = 0; i < moves / 2; ++i) {
+            a = std::move(b);
+            b = std::move(a);
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / (moves / 2 * 2);
+    }
+
+    template<typename T>
+    void benchmarkMoves(const char* label, T value, int moves) {
+        constexpr std::size_t n = 10000;
+
+        auto aw = std::make_unique<std::array<T, n>>();     // too big for the stack
+        std::vector<T> vw;
+        FixedVector<T, n> fw;
+
+        auto arrayNs = nsPerMove(*aw, [&](std::array<T, n>& a) { a.fill(value); }, moves);
+        auto vectorNs = nsPerMove(vw, [&](std::vector<T>& v) { v.assign(n, value); }, moves);
+        auto fixedNs = nsPerMove(fw, [&](FixedVector<T, n>& f) {
+            f.clear();
+            while (!f.full()) f.push_back(value);
+        }, moves);
+
+        std::cout << "moving " << n << " " << label << "s: std::array " << arrayNs
+                  << " ns, std::vector " << vectorNs << " ns, FixedVector " << fixedNs << " ns" << '\n';
+    }
 }
 
 
 int main() {
+   using namespace item29;
+
+   benchmarkMoves("int", 7, 2000);
+   benchmarkMoves("std::string", std::string("longer than the small-string buffer"), 200);
+
    return 0;
 }
@@ -2,6 +2,16 @@
 #include <set>
 #include <vector>
 #include <memory>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 
 // ITEM 30: Familiarize yourself with perfect forwarding failure cases.
@@ -420,6 +430,166 @@ namespace item30_bitfield {
         f(std::forward<Ts>(params)...);  // forward them to f
     }
 
+
+    // Besides not being perfect-forwardable, bit-fields have a compiler-defined
+    // layout (bit order, padding, endianness), so an IPv4Header can't be laid
+    // over the bytes of a real packet. IPv4HeaderView reads the fields straight
+    // out of the bytes instead: each field is described by its byte offset,
+    // size, shift and width, and the accessors are generated from that at
+    // compile time. Multi-byte fields are in network byte order.
+    template<std::size_t Offset, std::size_t Bytes, unsigned Shift = 0, unsigned Width = 8 * Bytes>
+    struct NetField {
+        static_assert(Bytes >= 1 && Bytes <= 4 && Shift + Width <= 8 * Bytes, "bad field layout");
+
+        static constexpr std::size_t end = Offset + Bytes;     // bytes needed to read it
+
+        static constexpr std::uint32_t get(const std::byte* p) noexcept {
+            std::uint32_t v = 0;
+            for (std::size_t i = 0; i < Bytes; ++i) {  // big endian; compilers turn this
+                v = (v << 8) | std::to_integer<std::uint32_t>(p[Offset + i]);  // into load + bswap
+            }
+            if constexpr (Width == 32) {
+                return v;
+            } else {
+                return (v >> Shift) & ((std::uint32_t{ 1 } << Width) - 1);
+            }
+        }
+    };
+
+    class IPv4HeaderView {
+    public:
+        using VersionField     = NetField<0, 1, 4, 4>;
+        using IHLField         = NetField<0, 1, 0, 4>;   // header length in 32-bit words
+        using DSCPField        = NetField<1, 1, 2, 6>;
+        using ECNField         = NetField<1, 1, 0, 2>;
+        using TotalLengthField = NetField<2, 2>;
+        using ProtocolField    = NetField<9, 1>;
+        using SourceField      = NetField<12, 4>;
+        using DestinationField = NetField<16, 4>;
+
+        static constexpr std::size_t minSize = 20;
+
+        constexpr explicit IPv4HeaderView(const std::byte* bytes) noexcept : p(bytes) {}
+
+        constexpr std::uint8_t version() const noexcept { return static_cast<std::uint8_t>(VersionField::get(p)); }
+        constexpr std::uint8_t ihl() const noexcept { return static_cast<std::uint8_t>(IHLField::get(p)); }
+        constexpr std::uint8_t dscp() const noexcept { return static_cast<std::uint8_t>(DSCPField::get(p)); }
+        constexpr std::uint8_t ecn() const noexcept { return static_cast<std::uint8_t>(ECNField::get(p)); }
+        constexpr std::uint16_t totalLength() const noexcept { return static_cast<std::uint16_t>(TotalLengthField::get(p)); }
+        constexpr std::uint8_t protocol() const noexcept { return static_cast<std::uint8_t>(ProtocolField::get(p)); }
+        constexpr std::uint32_t source() const noexcept { return SourceField::get(p); }
+        constexpr std::uint32_t destination() const noexcept { return DestinationField::get(p); }
+
+        constexpr std::size_t headerLength() const noexcept { return 4 * std::size_t{ ihl() }; }
+        constexpr const std::byte* data() const noexcept { return p; }
+
+        // true if the available bytes hold a well-formed IPv4 header
+        static constexpr bool valid(const std::byte* bytes, std::size_t available) noexcept {
+            if (available < minSize) return false;
+            IPv4HeaderView h(bytes);
+            return h.version() == 4 && h.ihl() >= 5 &&
+                   h.headerLength() <= available && h.headerLength() <= h.totalLength();
+        }
+
+    private:
+        const std::byte* p;
+    };
+
+    // Walks a pcap capture held in memory (typically an mmap'd file, see
+    // MappedFile below) and calls f with an IPv4HeaderView for every IPv4
+    // packet, pointing straight into the capture: nothing is copied. Handles
+    // both byte orders and the microsecond and nanosecond magics, for Ethernet
+    // (with 802.1Q tags) and raw IP link types. Returns the number of IPv4
+    // packets visited, or 0 if the data isn't a pcap capture.
+    template<typename F>
+    std::size_t forEachIPv4(const std::byte* data, std::size_t size, F&& f) {
+        constexpr std::size_t globalHeaderSize = 24, recordHeaderSize = 16;
+        constexpr std::uint32_t linkEthernet = 1, linkRaw = 101, linkIPv4 = 228;
+
+        if (size < globalHeaderSize) return 0;
+
+        auto magic = NetField<0, 4>::get(data);
+        bool swapped;   // true: the capture's fields are little endian
+        if (magic == 0xa1b2c3d4 || magic == 0xa1b23c4d) swapped = false;
+        else if (magic == 0xd4c3b2a1 || magic == 0x4d3cb2a1) swapped = true;
+        else return 0;
+
+        auto field32 = [swapped](const std::byte* p) {
+            auto v = NetField<0, 4>::get(p);
+            return swapped ? __builtin_bswap32(v) : v;
+        };
+
+        const auto linkType = field32(data + 20) & 0xFFFF;
+        if (linkType != linkEthernet && linkType != linkRaw && linkType != linkIPv4) return 0;
+
+        std::size_t visited = 0;
+        for (std::size_t pos = globalHeaderSize; size - pos >= recordHeaderSize; ) {
+            const auto capLen = field32(data + pos + 8);
+            pos += recordHeaderSize;
+            if (capLen > size - pos) break;         // truncated capture
+
+            const std::byte* pkt = data + pos;
+            std::size_t len = capLen;
+            pos += capLen;
+
+            if (linkType == linkEthernet) {
+                if (len < 14) continue;
+                auto etherType = NetField<12, 2>::get(pkt);
+                std::size_t l2 = 14;
+                while ((etherType == 0x8100 || etherType == 0x88a8) && len >= l2 + 4) {
+                    etherType = NetField<2, 2>::get(pkt + l2);      // VLAN tag
+                    l2 += 4;
+                }
+                if (etherType != 0x0800) continue;
+                pkt += l2;
+                len -= l2;
+            }
+
+            if (IPv4HeaderView::valid(pkt, len)) {
+                f(IPv4HeaderView(pkt));
+                ++visited;
+            }
+        }
+        return visited;
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    // read-only mapping of a whole file, for forEachIPv4
+    class MappedFile {
+    public:
+        explicit MappedFile(const char* path) {
+            int fd = ::open(path, O_RDONLY);
+            if (fd < 0) return;
+
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                                 PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    bytes = static_cast<const std::byte*>(p);
+                    length = static_cast<std::size_t>(st.st_size);
+                    ::madvise(p, length, MADV_SEQUENTIAL);
+                }
+            }
+            ::close(fd);
+        }
+
+        ~MappedFile() {
+            if (bytes) ::munmap(const_cast<std::byte*>(bytes), length);
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        explicit operator bool() const noexcept { return bytes != nullptr; }
+        const std::byte* data() const noexcept { return bytes; }
+        std::size_t size() const noexcept { return length; }
+
+    private:
+        const std::byte* bytes = nullptr;
+        std::size_t length = 0;
+    };
+#endif
 }
 
 
@@ -454,6 +624,20 @@ int main() {
 
    item30_bitfield::fwd(length);
 
+   // the same fields, read from the bytes of a real header
+   static constexpr std::byte packet[] = {
+       std::byte{0x45}, std::byte{0xb8}, std::byte{0x00}, std::byte{0x54},
+       std::byte{0x00}, std::byte{0x00}, std::byte{0x40}, std::byte{0x00},
+       std::byte{0x40}, std::byte{0x01}, std::byte{0x00}, std::byte{0x00},
+       std::byte{0x0a}, std::byte{0x00}, std::byte{0x00}, std::byte{0x01},
+       std::byte{0x0a}, std::byte{0x00}, std::byte{0x00}, std::byte{0x02},
+   };
+   constexpr item30_bitfield::IPv4HeaderView view(packet);
+   static_assert(view.version() == 4 && view.ihl() == 5, "decoded at compile time");
+   static_assert(view.dscp() == 46 && view.ecn() == 0 && view.totalLength() == 84, "");
+
+   item30_bitfield::fwd(view.totalLength());    // a plain value forwards fine
+
 
    return 0;
 }
@@ -3,6 +3,19 @@
 #include <random>
 #include <string>
 #include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <new>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ITEM31_X86_DISPATCH 1
+#endif
 
 
 // ITEM 31: Avoid default capture modes.
@@ -18,7 +31,164 @@
  * */
 
 namespace item31 {
-    using FilterContainer = std::vector<std::function<bool(int)>>;
+    namespace detail {
+        // The type erasure behind UniqueFunction and InplaceFunction: the
+        // closure sits in the wrapper's buffer (or on the heap, with a pointer
+        // to it in the buffer), and one static table per closure type says how
+        // to call, move, copy and destroy it. copy is null for closures that
+        // can't be copied, and for heap-stored ones, which only UniqueFunction
+        // uses.
+        template<typename R, typename... Args>
+        struct FunctionOps {
+            R (*invoke)(void* p, Args&&... args);
+            void (*move)(void* dst, void* src) noexcept;    // leaves src destroyed
+            void (*destroy)(void* p) noexcept;
+            void (*copy)(void* dst, const void* src);
+            bool storedInline;
+
+            template<typename Fn>
+            static const FunctionOps* inlineOps() noexcept {
+                static const FunctionOps ops{
+                    [](void* p, Args&&... args) -> R {
+                        return call(*static_cast<Fn*>(p), std::forward<Args>(args)...);
+                    },
+                    [](void* dst, void* src) noexcept {
+                        ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+                        static_cast<Fn*>(src)->~Fn();
+                    },
+                    [](void* p) noexcept { static_cast<Fn*>(p)->~Fn(); },
+                    copier<Fn>(),
+                    true
+                };
+                return &ops;
+            }
+
+            template<typename Fn>
+            static const FunctionOps* heapOps() noexcept {
+                static const FunctionOps ops{
+                    [](void* p, Args&&... args) -> R {
+                        return call(**static_cast<Fn**>(p), std::forward<Args>(args)...);
+                    },
+                    [](void* dst, void* src) noexcept {
+                        ::new (dst) Fn*(*static_cast<Fn**>(src));
+                    },
+                    [](void* p) noexcept { delete *static_cast<Fn**>(p); },
+                    nullptr,
+                    false
+                };
+                return &ops;
+            }
+
+        private:
+            template<typename Fn>
+            static R call(Fn& f, Args&&... args) {
+                if constexpr (std::is_void<R>::value) {
+                    f(std::forward<Args>(args)...);
+                } else {
+                    return f(std::forward<Args>(args)...);
+                }
+            }
+
+            template<typename Fn>
+            static constexpr auto copier() noexcept -> void (*)(void*, const void*) {
+                if constexpr (std::is_copy_constructible<Fn>::value) {
+                    return [](void* dst, const void* src) { ::new (dst) Fn(*static_cast<const Fn*>(src)); };
+                } else {
+                    return nullptr;
+                }
+            }
+        };
+    }
+
+    // std::function must be copyable, so it can't hold a closure that owns a
+    // std::unique_ptr (see Item 32), or a std::packaged_task. UniqueFunction is
+    // move-only instead, and so accepts those too. Closures that fit in Capacity
+    // bytes, and won't throw when moved, are stored inline without allocating;
+    // bigger ones go on the heap, once, and moving a UniqueFunction never
+    // allocates. Calling an empty one throws std::bad_function_call, as
+    // std::function does. The call operator isn't const: the closure may
+    // change its own state when called, and a const UniqueFunction shouldn't.
+    template<typename Signature, std::size_t Capacity = 4 * sizeof(void*)>
+    class UniqueFunction;
+
+    template<typename R, typename... Args, std::size_t Capacity>
+    class UniqueFunction<R(Args...), Capacity> {
+    public:
+        UniqueFunction() noexcept = default;
+        UniqueFunction(std::nullptr_t) noexcept {}
+
+        template<typename F,
+                 typename = std::enable_if_t<!std::is_same<std::decay_t<F>, UniqueFunction>::value &&
+                                             std::is_invocable_r<R, std::decay_t<F>&, Args...>::value>>
+        UniqueFunction(F&& f) {
+            using Fn = std::decay_t<F>;
+            if constexpr (fitsInline<Fn>()) {
+                ::new (static_cast<void*>(storage)) Fn(std::forward<F>(f));
+                ops = Ops::template inlineOps<Fn>();
+            } else {
+                ::new (static_cast<void*>(storage)) Fn*(new Fn(std::forward<F>(f)));
+                ops = Ops::template heapOps<Fn>();
+            }
+        }
+
+        UniqueFunction(UniqueFunction&& rhs) noexcept : ops(rhs.ops) {
+            if (ops) ops->move(storage, rhs.storage);
+            rhs.ops = nullptr;
+        }
+
+        UniqueFunction& operator=(UniqueFunction&& rhs) noexcept {
+            if (this != &rhs) {
+                reset();
+                if (rhs.ops) rhs.ops->move(storage, rhs.storage);
+                ops = rhs.ops;
+                rhs.ops = nullptr;
+            }
+            return *this;
+        }
+
+        UniqueFunction& operator=(std::nullptr_t) noexcept {
+            reset();
+            return *this;
+        }
+
+        UniqueFunction(const UniqueFunction&) = delete;
+        UniqueFunction& operator=(const UniqueFunction&) = delete;
+
+        ~UniqueFunction() { reset(); }
+
+        explicit operator bool() const noexcept { return ops != nullptr; }
+
+        // true if the closure lives inside this object rather than on the heap
+        bool storedInline() const noexcept { return ops && ops->storedInline; }
+
+        R operator()(Args... args) {
+            if (!ops) throw std::bad_function_call();
+            return ops->invoke(storage, std::forward<Args>(args)...);
+        }
+
+    private:
+        using Ops = detail::FunctionOps<R, Args...>;
+
+        template<typename Fn>
+        static constexpr bool fitsInline() noexcept {
+            return sizeof(Fn) <= Capacity &&
+                   alignof(Fn) <= alignof(std::max_align_t) &&
+                   std::is_nothrow_move_constructible<Fn>::value;
+        }
+
+        void reset() noexcept {
+            if (ops) ops->destroy(storage);
+            ops = nullptr;
+        }
+
+        static_assert(Capacity >= sizeof(void*), "UniqueFunction needs room for at least a pointer");
+
+        alignas(std::max_align_t) unsigned char storage[Capacity];
+        const Ops* ops = nullptr;
+    };
+
+    // filters may own what they capture; see Item 32
+    using FilterContainer = std::vector<UniqueFunction<bool(int)>>;
     FilterContainer filters;
 
     double computeSomeValue() {
@@ -47,6 +217,366 @@ namespace item31 {
         ); // now divisor can't dangle (copy by value)
     }
 
+    // The lambdas above test one int per call. When the same divisor filter is
+    // applied to millions of ints, DivisorFilter::evaluate tests a whole batch,
+    // writing 1 or 0 per element into mask. Divisibility by d = d0 * 2^k (d0 odd)
+    // needs no division at all:
+    //
+    //     n % d == 0   <=>   rotr(n * inverse(d0), k) <= (2^32 - 1) / d
+    //
+    // where inverse(d0) is d0's multiplicative inverse modulo 2^32, so one
+    // 32-bit multiply, a rotate and an unsigned compare per element; that maps
+    // directly onto SSE4.1 and AVX2, chosen at runtime from what the CPU supports.
+    //
+    // The filter tests whether the int value itself is divisible; the lambdas
+    // above promote value to std::size_t, which only differs for negative values
+    // (allOfPromoted reproduces that).
+    // A divisor of 0 (which computeDivisor can return) matches nothing.
+    class DivisorFilter {
+    public:
+        explicit DivisorFilter(std::size_t divisor) noexcept : d(divisor) {
+            if (d == 0 || d > std::numeric_limits<std::uint32_t>::max()) return;
+
+            auto d0 = static_cast<std::uint32_t>(d);
+            while ((d0 & 1) == 0) { d0 >>= 1; ++shift; }
+
+            inverse = d0;                       // correct to 3 bits for odd d0,
+            for (auto i = 0; i < 4; ++i) {      // each Newton step doubles that
+                inverse *= 2 - d0 * inverse;
+            }
+            limit = std::numeric_limits<std::uint32_t>::max() / static_cast<std::uint32_t>(d);
+        }
+
+        std::size_t divisor() const noexcept { return d; }
+
+        bool operator()(int value) const noexcept {
+            if (limit == 0) return d != 0 && value == 0;    // d == 0 or d > 2^32 - 1
+            return test(magnitude(value));
+        }
+
+        void evaluate(const int* in, std::size_t n, std::uint8_t* mask) const noexcept {
+            if (limit == 0) {
+                for (std::size_t i = 0; i < n; ++i) mask[i] = (*this)(in[i]);
+                return;
+            }
+            kernel()(*this, in, n, mask);
+        }
+
+        // true if every element of in[0, n) is divisible; stops at the first
+        // batch that has a value which isn't
+        bool allOf(const int* in, std::size_t n) const noexcept {
+            constexpr std::size_t batch = 256;
+            std::uint8_t mask[batch];
+
+            for (std::size_t first = 0; first < n; first += batch) {
+                auto count = std::min(batch, n - first);
+                evaluate(in + first, count, mask);
+
+                std::uint8_t all = 1;
+                for (std::size_t i = 0; i < count; ++i) all &= mask[i];
+                if (!all) return false;
+            }
+            return true;
+        }
+
+        // allOf with the lambdas' semantics: value % divisor promotes value to
+        // std::size_t, so a negative value is tested as 2^64 + value. Only the
+        // negative elements are retested, one at a time.
+        bool allOfPromoted(const int* in, std::size_t n) const noexcept {
+            constexpr std::size_t batch = 256;
+            std::uint8_t mask[batch];
+
+            for (std::size_t first = 0; first < n; first += batch) {
+                auto count = std::min(batch, n - first);
+                evaluate(in + first, count, mask);
+
+                std::uint8_t all = 1;
+                for (std::size_t i = 0; i < count; ++i) {
+                    auto value = in[first + i];
+                    all &= value < 0 ? static_cast<std::uint8_t>(d != 0 && static_cast<std::size_t>(value) % d == 0)
+                                     : mask[i];
+                }
+                if (!all) return false;
+            }
+            return true;
+        }
+
+    private:
+        using Kernel = void (*)(const DivisorFilter&, const int*, std::size_t, std::uint8_t*);
+
+        static std::uint32_t magnitude(int value) noexcept {   // |INT_MIN| fits too
+            auto u = static_cast<std::uint32_t>(value);
+            return value < 0 ? 0u - u : u;
+        }
+
+        bool test(std::uint32_t u) const noexcept {
+            auto q = u * inverse;
+            q = (q >> shift) | (q << ((32 - shift) & 31));
+            return q <= limit;
+        }
+
+        static void evaluateScalar(const DivisorFilter& f, const int* in,
+                                   std::size_t n, std::uint8_t* mask) noexcept {
+            for (std::size_t i = 0; i < n; ++i) mask[i] = f.test(magnitude(in[i]));
+        }
+
+#ifdef ITEM31_X86_DISPATCH
+        // lanes of all ones where p[0, 4) is divisible
+        __attribute__((target("sse4.1")))
+        static __m128i divisible4(const int* p, __m128i inv, __m128i lim,
+                                  __m128i sr, __m128i sl) noexcept {
+            auto u = _mm_abs_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+            auto q = _mm_mullo_epi32(u, inv);
+            q = _mm_or_si128(_mm_srl_epi32(q, sr), _mm_sll_epi32(q, sl));
+            return _mm_cmpeq_epi32(_mm_min_epu32(q, lim), q);
+        }
+
+        __attribute__((target("sse4.1")))
+        static void evaluateSSE41(const DivisorFilter& f, const int* in,
+                                  std::size_t n, std::uint8_t* mask) noexcept {
+            const auto inv = _mm_set1_epi32(static_cast<int>(f.inverse));
+            const auto lim = _mm_set1_epi32(static_cast<int>(f.limit));
+            const auto sr = _mm_cvtsi32_si128(static_cast<int>(f.shift));
+            const auto sl = _mm_cvtsi32_si128(static_cast<int>(32 - f.shift));
+            const auto one = _mm_set1_epi8(1);
+
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                auto lo = _mm_packs_epi32(divisible4(in + i, inv, lim, sr, sl),
+                                          divisible4(in + i + 4, inv, lim, sr, sl));
+                auto hi = _mm_packs_epi32(divisible4(in + i + 8, inv, lim, sr, sl),
+                                          divisible4(in + i + 12, inv, lim, sr, sl));
+                auto bytes = _mm_and_si128(_mm_packs_epi16(lo, hi), one);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(mask + i), bytes);
+            }
+            evaluateScalar(f, in + i, n - i, mask + i);
+        }
+
+        // lanes of all ones where p[0, 8) is divisible
+        __attribute__((target("avx2")))
+        static __m256i divisible8(const int* p, __m256i inv, __m256i lim,
+                                  __m128i sr, __m128i sl) noexcept {
+            auto u = _mm256_abs_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+            auto q = _mm256_mullo_epi32(u, inv);
+            q = _mm256_or_si256(_mm256_srl_epi32(q, sr), _mm256_sll_epi32(q, sl));
+            return _mm256_cmpeq_epi32(_mm256_min_epu32(q, lim), q);
+        }
+
+        __attribute__((target("avx2")))
+        static void evaluateAVX2(const DivisorFilter& f, const int* in,
+                                 std::size_t n, std::uint8_t* mask) noexcept {
+            const auto inv = _mm256_set1_epi32(static_cast<int>(f.inverse));
+            const auto lim = _mm256_set1_epi32(static_cast<int>(f.limit));
+            const auto sr = _mm_cvtsi32_si128(static_cast<int>(f.shift));
+            const auto sl = _mm_cvtsi32_si128(static_cast<int>(32 - f.shift));
+            const auto one = _mm256_set1_epi8(1);
+            const auto order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);  // undo the
+                                                                            // per-lane packs
+            std::size_t i = 0;
+            for (; i + 32 <= n; i += 32) {
+                auto lo = _mm256_packs_epi32(divisible8(in + i, inv, lim, sr, sl),
+                                             divisible8(in + i + 8, inv, lim, sr, sl));
+                auto hi = _mm256_packs_epi32(divisible8(in + i + 16, inv, lim, sr, sl),
+                                             divisible8(in + i + 24, inv, lim, sr, sl));
+                auto bytes = _mm256_permutevar8x32_epi32(_mm256_packs_epi16(lo, hi), order);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(mask + i),
+                                    _mm256_and_si256(bytes, one));
+            }
+            evaluateSSE41(f, in + i, n - i, mask + i);
+        }
+#endif
+
+        static Kernel kernel() noexcept {
+            static const Kernel k = [] {
+#ifdef ITEM31_X86_DISPATCH
+                if (__builtin_cpu_supports("avx2")) return &evaluateAVX2;
+                if (__builtin_cpu_supports("sse4.1")) return &evaluateSSE41;
+#endif
+                return &evaluateScalar;
+            }();
+            return k;
+        }
+
+        std::size_t d;
+        std::uint32_t inverse = 0;
+        std::uint32_t limit = 0;            // 0 means there's no 32-bit magic for d
+        unsigned shift = 0;
+    };
+
+    // A std::function may heap-allocate any closure that doesn't fit its (small,
+    // implementation-defined) buffer. InplaceFunction always stores the closure
+    // inline, in Capacity bytes, and refuses to compile if it doesn't fit. It's
+    // copyable, like std::function, and so has std::function's const call
+    // operator; the ops table is UniqueFunction's, with invoke cached beside it
+    // so a call costs one indirect jump.
+    template<typename Signature, std::size_t Capacity = 32>
+    class InplaceFunction;
+
+    template<typename R, typename... Args, std::size_t Capacity>
+    class InplaceFunction<R(Args...), Capacity> {
+    public:
+        InplaceFunction() noexcept = default;
+
+        template<typename F,
+                 typename = std::enable_if_t<!std::is_same<std::decay_t<F>, InplaceFunction>::value>>
+        InplaceFunction(F&& f) {
+            using Fn = std::decay_t<F>;
+            static_assert(sizeof(Fn) <= Capacity,
+                          "closure doesn't fit in InplaceFunction's inline storage");
+            static_assert(alignof(Fn) <= alignof(std::max_align_t),
+                          "closure is over-aligned for InplaceFunction's inline storage");
+            static_assert(std::is_nothrow_move_constructible<Fn>::value,
+                          "InplaceFunction requires a nothrow-movable closure");
+            static_assert(std::is_copy_constructible<Fn>::value,
+                          "InplaceFunction requires a copyable closure");
+
+            ::new (static_cast<void*>(storage)) Fn(std::forward<F>(f));
+            ops = Ops::template inlineOps<Fn>();
+            invoker = ops->invoke;
+        }
+
+        InplaceFunction(const InplaceFunction& rhs) : invoker(rhs.invoker), ops(rhs.ops) {
+            if (ops) ops->copy(storage, rhs.storage);
+        }
+
+        InplaceFunction(InplaceFunction&& rhs) noexcept : invoker(rhs.invoker), ops(rhs.ops) {
+            if (ops) ops->move(storage, rhs.storage);
+            rhs.invoker = nullptr;
+            rhs.ops = nullptr;
+        }
+
+        InplaceFunction& operator=(const InplaceFunction& rhs) {
+            if (this != &rhs) {
+                InplaceFunction tmp(rhs);   // copy first, in case it throws
+                *this = std::move(tmp);
+            }
+            return *this;
+        }
+
+        InplaceFunction& operator=(InplaceFunction&& rhs) noexcept {
+            if (this != &rhs) {
+                reset();
+                if (rhs.ops) rhs.ops->move(storage, rhs.storage);
+                invoker = rhs.invoker;
+                ops = rhs.ops;
+                rhs.invoker = nullptr;
+                rhs.ops = nullptr;
+            }
+            return *this;
+        }
+
+        ~InplaceFunction() { reset(); }
+
+        explicit operator bool() const noexcept { return invoker != nullptr; }
+
+        R operator()(Args... args) const {
+            return invoker(storage, std::forward<Args>(args)...);
+        }
+
+    private:
+        using Ops = detail::FunctionOps<R, Args...>;
+
+        void reset() noexcept {
+            if (ops) ops->destroy(storage);
+            invoker = nullptr;
+            ops = nullptr;
+        }
+
+        alignas(std::max_align_t) mutable unsigned char storage[Capacity];
+        R (*invoker)(void*, Args&&...) = nullptr;
+        const Ops* ops = nullptr;
+    };
+
+    // A filter registry that never allocates per filter: closures live inline,
+    // one after another, in a single contiguous array of InplaceFunctions, and
+    // running the whole set allocates nothing. A value passes if every filter
+    // accepts it.
+    //
+    // DivisorFilters are recognised and fused: n is divisible by each of d1..dk
+    // exactly when it's divisible by lcm(d1..dk), so however many divisor filters
+    // are added, they cost a single DivisorFilter test (or a single SIMD pass in
+    // evaluate). Only the remaining, opaque filters are called one by one.
+    class FlatFilterContainer {
+    public:
+        static constexpr std::size_t inlineCapacity = 32;
+        using Filter = InplaceFunction<bool(int), inlineCapacity>;
+
+        void reserve(std::size_t n) { filters.reserve(n); }
+
+        template<typename F>
+        void add(F&& f) {
+            if constexpr (std::is_same<std::decay_t<F>, DivisorFilter>::value) {
+                addDivisor(f.divisor());
+            } else {
+                filters.emplace_back(std::forward<F>(f));
+            }
+        }
+
+        std::size_t size() const noexcept { return filters.size() + numDivisors; }
+        bool empty() const noexcept { return size() == 0; }
+
+        bool operator()(int value) const {
+            if (numDivisors != 0 && !fused(value)) return false;
+            for (auto& f : filters) {
+                if (!f(value)) return false;
+            }
+            return true;
+        }
+
+        // mask[i] = 1 if in[i] passes every filter, 0 otherwise
+        void evaluate(const int* in, std::size_t n, std::uint8_t* mask) const {
+            if (numDivisors != 0) {
+                fused.evaluate(in, n, mask);
+            } else {
+                std::fill(mask, mask + n, std::uint8_t{ 1 });
+            }
+
+            if (filters.empty()) return;
+
+            for (std::size_t i = 0; i < n; ++i) {
+                if (!mask[i]) continue;
+                for (auto& f : filters) {
+                    if (!f(in[i])) { mask[i] = 0; break; }
+                }
+            }
+        }
+
+    private:
+        void addDivisor(std::size_t d) {
+            // |value| <= 2^31, so any divisor above 2^31 is only satisfied by 0;
+            // clamping the lcm at 2^32 keeps that meaning without overflowing
+            constexpr std::uint64_t clamp = std::uint64_t{ 1 } << 32;
+
+            std::uint64_t l = std::min<std::uint64_t>(d, clamp);
+            if (numDivisors != 0) {
+                std::uint64_t prev = fused.divisor();
+                if (prev == 0 || l == 0) {
+                    l = 0;                          // nothing is divisible by 0
+                } else {
+                    auto a = prev / std::gcd(prev, l);
+                    l = (a > clamp / l) ? clamp : std::min(a * l, clamp);
+                }
+            }
+
+            fused = DivisorFilter(static_cast<std::size_t>(l));
+            ++numDivisors;
+        }
+
+        std::vector<Filter> filters;
+        DivisorFilter fused{ 1 };
+        std::size_t numDivisors = 0;
+    };
+
+    // containers whose elements are ints laid out contiguously, so they can be
+    // handed to DivisorFilter::evaluate as a plain pointer and a count
+    template<typename C, typename = void>
+    struct IsContiguousIntContainer: std::false_type {};
+
+    template<typename C>
+    struct IsContiguousIntContainer<C, std::void_t<decltype(std::declval<const C&>().data()),
+                                                   decltype(std::declval<const C&>().size())>>
+        : std::is_same<decltype(std::declval<const C&>().data()), const int*> {};
+
     template<typename C>
     void workWithContainer(const C& container) {
         auto calc1 = computeSomeValue();
@@ -60,9 +590,16 @@ namespace item31 {
         using std::begin;
         using std::end;
 
-        if (std::all_of(
-              begin(container), end(container),
-              [&](const ContElemT& value) { return value % divisor == 0; })) {
+        bool allSatisfied;
+        if constexpr (IsContiguousIntContainer<C>::value) {
+            allSatisfied = DivisorFilter(divisor).allOfPromoted(container.data(), container.size());
+        } else {
+            allSatisfied = std::all_of(
+                begin(container), end(container),
+                [&](const ContElemT& value) { return value % divisor == 0; });
+        }
+
+        if (allSatisfied) {
             std::cout << "all statisfied" << "\n";
         }
     }
@@ -111,10 +648,34 @@ int main() {
 
     std::cout << std::boolalpha << filters[1](31321) << "\n";
 
+    // a filter that owns its divisor, which std::function couldn't hold
+    auto divisor = std::make_unique<int>(11);
+    filters.emplace_back(
+            [divisor = std::move(divisor)](int value) { return value % *divisor == 0; }
+    );
+    std::cout << filters.back()(31321) << ", stored inline: " << filters.back().storedInline() << "\n";
+
     auto vec = std::vector<int>({120, 160});
 
     workWithContainer(vec);
 
+    // one divisor filter, a million ints
+    std::vector<int> values(1'000'000);
+    for (std::size_t i = 0; i < values.size(); ++i) values[i] = static_cast<int>(i) - 500'000;
+
+    std::vector<std::uint8_t> mask(values.size());
+    DivisorFilter(7).evaluate(values.data(), values.size(), mask.data());
+    std::cout << std::count(mask.begin(), mask.end(), 1) << " divisible by 7" << "\n";
+
+    // divisor filters fused into one pass, plus an opaque filter
+    FlatFilterContainer flat;
+    flat.add(DivisorFilter(3));
+    flat.add(DivisorFilter(4));
+    flat.add([](int value) { return value > 0; });
+
+    flat.evaluate(values.data(), values.size(), mask.data());
+    std::cout << std::count(mask.begin(), mask.end(), 1) << " positive multiples of 12" << "\n";
+
 
     return 0;
 }
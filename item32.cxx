@@ -5,6 +5,10 @@
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
 
 
 // ITEM 32: Use init capture to move objects into closures.
@@ -19,7 +23,164 @@
  * */
 
 namespace item31 {
-    using FilterContainer = std::vector<std::function<bool(int)>>;
+    namespace detail {
+        // The type erasure behind UniqueFunction and InplaceFunction: the
+        // closure sits in the wrapper's buffer (or on the heap, with a pointer
+        // to it in the buffer), and one static table per closure type says how
+        // to call, move, copy and destroy it. copy is null for closures that
+        // can't be copied, and for heap-stored ones, which only UniqueFunction
+        // uses.
+        template<typename R, typename... Args>
+        struct FunctionOps {
+            R (*invoke)(void* p, Args&&... args);
+            void (*move)(void* dst, void* src) noexcept;    // leaves src destroyed
+            void (*destroy)(void* p) noexcept;
+            void (*copy)(void* dst, const void* src);
+            bool storedInline;
+
+            template<typename Fn>
+            static const FunctionOps* inlineOps() noexcept {
+                static const FunctionOps ops{
+                    [](void* p, Args&&... args) -> R {
+                        return call(*static_cast<Fn*>(p), std::forward<Args>(args)...);
+                    },
+                    [](void* dst, void* src) noexcept {
+                        ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+                        static_cast<Fn*>(src)->~Fn();
+                    },
+                    [](void* p) noexcept { static_cast<Fn*>(p)->~Fn(); },
+                    copier<Fn>(),
+                    true
+                };
+                return &ops;
+            }
+
+            template<typename Fn>
+            static const FunctionOps* heapOps() noexcept {
+                static const FunctionOps ops{
+                    [](void* p, Args&&... args) -> R {
+                        return call(**static_cast<Fn**>(p), std::forward<Args>(args)...);
+                    },
+                    [](void* dst, void* src) noexcept {
+                        ::new (dst) Fn*(*static_cast<Fn**>(src));
+                    },
+                    [](void* p) noexcept { delete *static_cast<Fn**>(p); },
+                    nullptr,
+                    false
+                };
+                return &ops;
+            }
+
+        private:
+            template<typename Fn>
+            static R call(Fn& f, Args&&... args) {
+                if constexpr (std::is_void<R>::value) {
+                    f(std::forward<Args>(args)...);
+                } else {
+                    return f(std::forward<Args>(args)...);
+                }
+            }
+
+            template<typename Fn>
+            static constexpr auto copier() noexcept -> void (*)(void*, const void*) {
+                if constexpr (std::is_copy_constructible<Fn>::value) {
+                    return [](void* dst, const void* src) { ::new (dst) Fn(*static_cast<const Fn*>(src)); };
+                } else {
+                    return nullptr;
+                }
+            }
+        };
+    }
+
+    // std::function must be copyable, so it can't hold a closure that owns a
+    // std::unique_ptr (see Item 32), or a std::packaged_task. UniqueFunction is
+    // move-only instead, and so accepts those too. Closures that fit in Capacity
+    // bytes, and won't throw when moved, are stored inline without allocating;
+    // bigger ones go on the heap, once, and moving a UniqueFunction never
+    // allocates. Calling an empty one throws std::bad_function_call, as
+    // std::function does. The call operator isn't const: the closure may
+    // change its own state when called, and a const UniqueFunction shouldn't.
+    template<typename Signature, std::size_t Capacity = 4 * sizeof(void*)>
+    class UniqueFunction;
+
+    template<typename R, typename... Args, std::size_t Capacity>
+    class UniqueFunction<R(Args...), Capacity> {
+    public:
+        UniqueFunction() noexcept = default;
+        UniqueFunction(std::nullptr_t) noexcept {}
+
+        template<typename F,
+                 typename = std::enable_if_t<!std::is_same<std::decay_t<F>, UniqueFunction>::value &&
+                                             std::is_invocable_r<R, std::decay_t<F>&, Args...>::value>>
+        UniqueFunction(F&& f) {
+            using Fn = std::decay_t<F>;
+            if constexpr (fitsInline<Fn>()) {
+                ::new (static_cast<void*>(storage)) Fn(std::forward<F>(f));
+                ops = Ops::template inlineOps<Fn>();
+            } else {
+                ::new (static_cast<void*>(storage)) Fn*(new Fn(std::forward<F>(f)));
+                ops = Ops::template heapOps<Fn>();
+            }
+        }
+
+        UniqueFunction(UniqueFunction&& rhs) noexcept : ops(rhs.ops) {
+            if (ops) ops->move(storage, rhs.storage);
+            rhs.ops = nullptr;
+        }
+
+        UniqueFunction& operator=(UniqueFunction&& rhs) noexcept {
+            if (this != &rhs) {
+                reset();
+                if (rhs.ops) rhs.ops->move(storage, rhs.storage);
+                ops = rhs.ops;
+                rhs.ops = nullptr;
+            }
+            return *this;
+        }
+
+        UniqueFunction& operator=(std::nullptr_t) noexcept {
+            reset();
+            return *this;
+        }
+
+        UniqueFunction(const UniqueFunction&) = delete;
+        UniqueFunction& operator=(const UniqueFunction&) = delete;
+
+        ~UniqueFunction() { reset(); }
+
+        explicit operator bool() const noexcept { return ops != nullptr; }
+
+        // true if the closure lives inside this object rather than on the heap
+        bool storedInline() const noexcept { return ops && ops->storedInline; }
+
+        R operator()(Args... args) {
+            if (!ops) throw std::bad_function_call();
+            return ops->invoke(storage, std::forward<Args>(args)...);
+        }
+
+    private:
+        using Ops = detail::FunctionOps<R, Args...>;
+
+        template<typename Fn>
+        static constexpr bool fitsInline() noexcept {
+            return sizeof(Fn) <= Capacity &&
+                   alignof(Fn) <= alignof(std::max_align_t) &&
+                   std::is_nothrow_move_constructible<Fn>::value;
+        }
+
+        void reset() noexcept {
+            if (ops) ops->destroy(storage);
+            ops = nullptr;
+        }
+
+        static_assert(Capacity >= sizeof(void*), "UniqueFunction needs room for at least a pointer");
+
+        alignas(std::max_align_t) unsigned char storage[Capacity];
+        const Ops* ops = nullptr;
+    };
+
+    // filters may own what they capture; see Item 32
+    using FilterContainer = std::vector<UniqueFunction<bool(int)>>;
     FilterContainer filters;
 
     double computeSomeValue() {
@@ -145,6 +306,26 @@ int main() {
     // in C++ 11
     auto func_isValAndArch = IsValAndArch(std::make_unique<Widget>());
 
+    // both closures own their Widget, so they're move-only: a std::function
+    // can't hold them, a UniqueFunction can, without allocating
+    std::vector<item31::UniqueFunction<bool()>> checks;
+    checks.emplace_back(std::move(func));
+    checks.emplace_back(std::move(func_isValAndArch));
+
+    auto passed = std::count_if(checks.begin(), checks.end(),
+                                [](auto& check) { return check(); });
+
+    // and the same goes for item31's filters
+    item31::filters.emplace_back(
+            [pw = std::make_unique<Widget>()](int value) { return pw->isProcessed() && value > 0; }
+    );
+
+    std::cout << passed << " of " << checks.size() << " checks passed, "
+              << std::boolalpha << "all inline: "
+              << std::all_of(checks.begin(), checks.end(),
+                             [](const auto& check) { return check.storedInline(); })
+              << ", filter: " << item31::filters.back()(1) << '\n';
+
 
     return 0;
 }
@@ -1,5 +1,18 @@
 #include <iostream>
 #include <future>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 
 // ITEM 36: Specify std::launch::async if asynchronicity is essential.
@@ -18,6 +31,164 @@
  *
  * */
 
+namespace item31 {
+    namespace detail {
+        // The type erasure behind UniqueFunction and InplaceFunction: the
+        // closure sits in the wrapper's buffer (or on the heap, with a pointer
+        // to it in the buffer), and one static table per closure type says how
+        // to call, move, copy and destroy it. copy is null for closures that
+        // can't be copied, and for heap-stored ones, which only UniqueFunction
+        // uses.
+        template<typename R, typename... Args>
+        struct FunctionOps {
+            R (*invoke)(void* p, Args&&... args);
+            void (*move)(void* dst, void* src) noexcept;    // leaves src destroyed
+            void (*destroy)(void* p) noexcept;
+            void (*copy)(void* dst, const void* src);
+            bool storedInline;
+
+            template<typename Fn>
+            static const FunctionOps* inlineOps() noexcept {
+                static const FunctionOps ops{
+                    [](void* p, Args&&... args) -> R {
+                        return call(*static_cast<Fn*>(p), std::forward<Args>(args)...);
+                    },
+                    [](void* dst, void* src) noexcept {
+                        ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+                        static_cast<Fn*>(src)->~Fn();
+                    },
+                    [](void* p) noexcept { static_cast<Fn*>(p)->~Fn(); },
+                    copier<Fn>(),
+                    true
+                };
+                return &ops;
+            }
+
+            template<typename Fn>
+            static const FunctionOps* heapOps() noexcept {
+                static const FunctionOps ops{
+                    [](void* p, Args&&... args) -> R {
+                        return call(**static_cast<Fn**>(p), std::forward<Args>(args)...);
+                    },
+                    [](void* dst, void* src) noexcept {
+                        ::new (dst) Fn*(*static_cast<Fn**>(src));
+                    },
+                    [](void* p) noexcept { delete *static_cast<Fn**>(p); },
+                    nullptr,
+                    false
+                };
+                return &ops;
+            }
+
+        private:
+            template<typename Fn>
+            static R call(Fn& f, Args&&... args) {
+                if constexpr (std::is_void<R>::value) {
+                    f(std::forward<Args>(args)...);
+                } else {
+                    return f(std::forward<Args>(args)...);
+                }
+            }
+
+            template<typename Fn>
+            static constexpr auto copier() noexcept -> void (*)(void*, const void*) {
+                if constexpr (std::is_copy_constructible<Fn>::value) {
+                    return [](void* dst, const void* src) { ::new (dst) Fn(*static_cast<const Fn*>(src)); };
+                } else {
+                    return nullptr;
+                }
+            }
+        };
+    }
+
+    // std::function must be copyable, so it can't hold a closure that owns a
+    // std::unique_ptr (see Item 32), or a std::packaged_task. UniqueFunction is
+    // move-only instead, and so accepts those too. Closures that fit in Capacity
+    // bytes, and won't throw when moved, are stored inline without allocating;
+    // bigger ones go on the heap, once, and moving a UniqueFunction never
+    // allocates. Calling an empty one throws std::bad_function_call, as
+    // std::function does. The call operator isn't const: the closure may
+    // change its own state when called, and a const UniqueFunction shouldn't.
+    template<typename Signature, std::size_t Capacity = 4 * sizeof(void*)>
+    class UniqueFunction;
+
+    template<typename R, typename... Args, std::size_t Capacity>
+    class UniqueFunction<R(Args...), Capacity> {
+    public:
+        UniqueFunction() noexcept = default;
+        UniqueFunction(std::nullptr_t) noexcept {}
+
+        template<typename F,
+                 typename = std::enable_if_t<!std::is_same<std::decay_t<F>, UniqueFunction>::value &&
+                                             std::is_invocable_r<R, std::decay_t<F>&, Args...>::value>>
+        UniqueFunction(F&& f) {
+            using Fn = std::decay_t<F>;
+            if constexpr (fitsInline<Fn>()) {
+                ::new (static_cast<void*>(storage)) Fn(std::forward<F>(f));
+                ops = Ops::template inlineOps<Fn>();
+            } else {
+                ::new (static_cast<void*>(storage)) Fn*(new Fn(std::forward<F>(f)));
+                ops = Ops::template heapOps<Fn>();
+            }
+        }
+
+        UniqueFunction(UniqueFunction&& rhs) noexcept : ops(rhs.ops) {
+            if (ops) ops->move(storage, rhs.storage);
+            rhs.ops = nullptr;
+        }
+
+        UniqueFunction& operator=(UniqueFunction&& rhs) noexcept {
+            if (this != &rhs) {
+                reset();
+                if (rhs.ops) rhs.ops->move(storage, rhs.storage);
+                ops = rhs.ops;
+                rhs.ops = nullptr;
+            }
+            return *this;
+        }
+
+        UniqueFunction& operator=(std::nullptr_t) noexcept {
+            reset();
+            return *this;
+        }
+
+        UniqueFunction(const UniqueFunction&) = delete;
+        UniqueFunction& operator=(const UniqueFunction&) = delete;
+
+        ~UniqueFunction() { reset(); }
+
+        explicit operator bool() const noexcept { return ops != nullptr; }
+
+        // true if the closure lives inside this object rather than on the heap
+        bool storedInline() const noexcept { return ops && ops->storedInline; }
+
+        R operator()(Args... args) {
+            if (!ops) throw std::bad_function_call();
+            return ops->invoke(storage, std::forward<Args>(args)...);
+        }
+
+    private:
+        using Ops = detail::FunctionOps<R, Args...>;
+
+        template<typename Fn>
+        static constexpr bool fitsInline() noexcept {
+            return sizeof(Fn) <= Capacity &&
+                   alignof(Fn) <= alignof(std::max_align_t) &&
+                   std::is_nothrow_move_constructible<Fn>::value;
+        }
+
+        void reset() noexcept {
+            if (ops) ops->destroy(storage);
+            ops = nullptr;
+        }
+
+        static_assert(Capacity >= sizeof(void*), "UniqueFunction needs room for at least a pointer");
+
+        alignas(std::max_align_t) unsigned char storage[Capacity];
+        const Ops* ops = nullptr;
+    };
+}
+
 namespace item35 {
     int doAsyncwork(int value) { return value; };
 }
@@ -70,6 +241,285 @@ namespace item36 {
                           std::forward<Ts>(params)...);
     }
 
+
+    // std::launch::async typically means a brand new thread per call, and at
+    // thousands of tasks per second creating threads dominates. A fixed-size pool
+    // keeps the guarantee that matters (the task runs on some other thread, it's
+    // never deferred to get or wait) without paying for thread creation each time.
+
+    // Chase-Lev work-stealing deque. Only the owning thread may push and pop, at the
+    // bottom; any thread may steal from the top. Elements must be trivially
+    // copyable (the pool stores raw task pointers).
+    template<typename T>
+    class WorkStealingDeque {
+    public:
+        explicit WorkStealingDeque(std::size_t capacity = 256)
+            : array(new Array(capacity)) { retired.emplace_back(array.load()); }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        void push(T x) {                    // owner only
+            auto b = bottom.load(std::memory_order_relaxed);
+            auto t = top.load(std::memory_order_acquire);
+            auto a = array.load(std::memory_order_relaxed);
+
+            if (b - t > static_cast<std::int64_t>(a->size) - 1) {   // full, double it
+                a = a->grow(b, t);
+                retired.emplace_back(a);    // stealers may still read the old array,
+                array.store(a, std::memory_order_release);  // so keep it until we die
+            }
+
+            a->put(b, x);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+
+        bool pop(T& x) {                    // owner only
+            auto b = bottom.load(std::memory_order_relaxed) - 1;
+            auto a = array.load(std::memory_order_relaxed);
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto t = top.load(std::memory_order_relaxed);
+
+            if (t > b) {                    // empty
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return false;
+            }
+
+            x = a->get(b);
+            if (t == b) {                   // last element, race against stealers
+                bool won = top.compare_exchange_strong(t, t + 1,
+                                                       std::memory_order_seq_cst,
+                                                       std::memory_order_relaxed);
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return won;
+            }
+            return true;
+        }
+
+        bool steal(T& x) {                  // any thread
+            auto t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto b = bottom.load(std::memory_order_acquire);
+
+            if (t >= b) return false;       // empty
+
+            auto a = array.load(std::memory_order_acquire);
+            x = a->get(t);
+            return top.compare_exchange_strong(t, t + 1,
+                                               std::memory_order_seq_cst,
+                                               std::memory_order_relaxed);
+        }
+
+    private:
+        struct Array {
+            explicit Array(std::size_t n) : size(n), slots(new std::atomic<T>[n]) {}
+
+            T get(std::int64_t i) const {
+                return slots[i & (size - 1)].load(std::memory_order_relaxed);
+            }
+            void put(std::int64_t i, T x) {
+                slots[i & (size - 1)].store(x, std::memory_order_relaxed);
+            }
+            Array* grow(std::int64_t b, std::int64_t t) const {
+                auto a = new Array(2 * size);
+                for (auto i = t; i != b; ++i) a->put(i, get(i));
+                return a;
+            }
+
+            const std::size_t size;         // always a power of two
+            std::unique_ptr<std::atomic<T>[]> slots;
+        };
+
+        alignas(64) std::atomic<std::int64_t> top{ 0 };
+        alignas(64) std::atomic<std::int64_t> bottom{ 0 };
+        std::atomic<Array*> array;
+        std::vector<std::unique_ptr<Array>> retired;
+    };
+
+
+    // Fixed-size work-stealing thread pool. Each worker owns a WorkStealingDeque;
+    // tasks submitted from a worker go onto its own deque, tasks submitted from
+    // any other thread go onto a shared injection queue. Idle workers steal from
+    // their peers before going to sleep. The destructor runs every task that's
+    // already been submitted, then joins the workers.
+    //
+    // A task that blocks on the future of a task it submitted can deadlock the
+    // pool: the subtask sits on the blocked worker's own deque, and with one
+    // worker (or with every worker doing the same) nobody is left to steal it.
+    // Such a task should wait with get(fut), which runs queued tasks on the
+    // waiting thread until fut is ready.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned numThreads = std::thread::hardware_concurrency()) {
+            if (numThreads == 0) numThreads = 1;
+
+            for (unsigned i = 0; i < numThreads; ++i) {
+                queues.emplace_back(std::make_unique<WorkStealingDeque<Task*>>());
+            }
+            for (unsigned i = 0; i < numThreads; ++i) {
+                workers.emplace_back([this, i] { workerLoop(i); });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> g(m);
+                done = true;
+            }
+            cv.notify_all();
+            for (auto& t : workers) t.join();
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        std::size_t size() const noexcept { return workers.size(); }
+
+        template<typename F, typename... Ts>
+        auto submit(F&& f, Ts&&... params) {
+            using ResultType = std::invoke_result_t<std::decay_t<F>, std::decay_t<Ts>...>;
+
+            // like std::async, decay-copy the callable and its arguments
+            std::packaged_task<ResultType()> task(
+                [f = std::forward<F>(f),
+                 args = std::make_tuple(std::forward<Ts>(params)...)]() mutable {
+                    return std::apply(std::move(f), std::move(args));
+                });
+            auto fut = task.get_future();
+
+            post(std::move(task));
+
+            return fut;
+        }
+
+        // fire and forget: no future, and no shared state to allocate for one.
+        // The closure is moved into the queued task as it is, so a move-only
+        // one that fits UniqueFunction's buffer costs just the queue node.
+        // There's nowhere to report an exception, so one that escapes f ends
+        // the program, as it would from a std::thread.
+        void post(item31::UniqueFunction<void()> f) {
+            auto t = std::make_unique<Task>(std::move(f));
+            enqueue(t.get());
+            t.release();
+        }
+
+        // fut.get(), helping out while fut isn't ready: queued tasks, the one
+        // fut is waiting for among them, run on this thread. Once nothing is
+        // queued, fut's task is running elsewhere (or done), so blocking is safe.
+        template<typename R>
+        R get(std::future<R>& fut) {
+            while (fut.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                auto& self = currentWorker();
+                auto t = self.pool == this ? findTask(self.index) : findForeignTask(0);
+                if (!t) break;
+                run(t);
+            }
+            return fut.get();
+        }
+
+    private:
+        struct Task {
+            explicit Task(item31::UniqueFunction<void()>&& f) noexcept : run(std::move(f)) {}
+            item31::UniqueFunction<void()> run;
+        };
+
+        struct WorkerId {
+            const ThreadPool* pool;
+            unsigned index;
+        };
+
+        static WorkerId& currentWorker() {
+            thread_local WorkerId id{ nullptr, 0 };
+            return id;
+        }
+
+        void enqueue(Task* t) {
+            auto& self = currentWorker();
+            if (self.pool == this) {
+                queues[self.index]->push(t);
+            } else {
+                std::lock_guard<std::mutex> g(injectM);
+                injected.push_back(t);
+            }
+
+            pending.fetch_add(1, std::memory_order_release);
+            { std::lock_guard<std::mutex> g(m); }   // a worker between checking pending
+            cv.notify_one();                        // and blocking can't miss this
+        }
+
+        Task* findTask(unsigned i) {
+            Task* t = nullptr;
+
+            if (queues[i]->pop(t)) return t;
+            return findForeignTask(i + 1);
+        }
+
+        // from the injection queue, or stolen from the deques, starting at first
+        Task* findForeignTask(std::size_t first) {
+            Task* t = nullptr;
+
+            {
+                std::lock_guard<std::mutex> g(injectM);
+                if (!injected.empty()) {
+                    t = injected.front();
+                    injected.pop_front();
+                    return t;
+                }
+            }
+
+            for (std::size_t n = 0; n < queues.size(); ++n) {
+                if (queues[(first + n) % queues.size()]->steal(t)) return t;
+            }
+
+            return nullptr;
+        }
+
+        void run(Task* t) {
+            pending.fetch_sub(1, std::memory_order_relaxed);
+            std::unique_ptr<Task> owner(t);
+            owner->run();                   // packaged_task stores any exception
+        }
+
+        void workerLoop(unsigned i) {
+            currentWorker() = WorkerId{ this, i };
+
+            for (;;) {
+                if (auto t = findTask(i)) {
+                    run(t);
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> g(m);
+                cv.wait(g, [this] {
+                    return done || pending.load(std::memory_order_acquire) > 0;
+                });
+                if (done && pending.load(std::memory_order_acquire) <= 0) return;
+            }
+        }
+
+        std::vector<std::unique_ptr<WorkStealingDeque<Task*>>> queues;
+
+        std::mutex injectM;
+        std::deque<Task*> injected;
+
+        std::atomic<long> pending{ 0 };     // submitted, but not yet picked up
+        std::mutex m;
+        std::condition_variable cv;
+        bool done = false;
+
+        std::vector<std::thread> workers;   // declared last, see Item 37
+    };
+
+    // same guarantee as above (f won't be deferred and won't run on the calling
+    // thread), but f runs on one of pool's workers instead of a fresh thread
+    template<typename F, typename... Ts>
+    inline auto reallyAsync(ThreadPool& pool, F&& f, Ts&&... params) {
+        return pool.submit(std::forward<F>(f),
+                           std::forward<Ts>(params)...);
+    }
+
 }
 
 int main() {
@@ -96,6 +546,32 @@ int main() {
         // fut is ready
     }
 
+    ThreadPool pool;
+    std::vector<std::future<int>> futs;
+    for (auto i = 0; i < 1000; ++i) {
+        futs.push_back(reallyAsync(pool, item35::doAsyncwork, i));
+    }
+
+    auto sum = 0;
+    for (auto& fu : futs) sum += fu.get();
+    std::cout << "sum: " << sum << '\n';
+
+    // move-only tasks, each owning its argument
+    std::atomic<int> posted{ 0 };
+    for (auto i = 0; i < 1000; ++i) {
+        pool.post([&posted, value = std::make_unique<int>(i)] { posted += item35::doAsyncwork(*value); });
+    }
+    while (posted.load() != sum) std::this_thread::yield();
+    std::cout << "posted: " << posted.load() << '\n';
+
+    // a task waiting on its own subtask, on a pool with nobody else to run it
+    ThreadPool single(1);
+    auto outer = single.submit([&single] {
+        auto inner = single.submit([] { return 2; });
+        return 21 * single.get(inner);      // inner.get() would never return
+    });
+    std::cout << "nested: " << outer.get() << '\n';
+
 
     return 0;
 }
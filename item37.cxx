@@ -2,6 +2,13 @@
 #include <future>
 #include <vector>
 #include <memory>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <cstddef>
+#include <new>
+#include <type_traits>
 
 
 // ITEM 37: Make std::threads unjoinable on all paths.
@@ -19,6 +26,164 @@
  *
  * */
 
+namespace item31 {
+    namespace detail {
+        // The type erasure behind UniqueFunction and InplaceFunction: the
+        // closure sits in the wrapper's buffer (or on the heap, with a pointer
+        // to it in the buffer), and one static table per closure type says how
+        // to call, move, copy and destroy it. copy is null for closures that
+        // can't be copied, and for heap-stored ones, which only UniqueFunction
+        // uses.
+        template<typename R, typename... Args>
+        struct FunctionOps {
+            R (*invoke)(void* p, Args&&... args);
+            void (*move)(void* dst, void* src) noexcept;    // leaves src destroyed
+            void (*destroy)(void* p) noexcept;
+            void (*copy)(void* dst, const void* src);
+            bool storedInline;
+
+            template<typename Fn>
+            static const FunctionOps* inlineOps() noexcept {
+                static const FunctionOps ops{
+                    [](void* p, Args&&... args) -> R {
+                        return call(*static_cast<Fn*>(p), std::forward<Args>(args)...);
+                    },
+                    [](void* dst, void* src) noexcept {
+                        ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+                        static_cast<Fn*>(src)->~Fn();
+                    },
+                    [](void* p) noexcept { static_cast<Fn*>(p)->~Fn(); },
+                    copier<Fn>(),
+                    true
+                };
+                return &ops;
+            }
+
+            template<typename Fn>
+            static const FunctionOps* heapOps() noexcept {
+                static const FunctionOps ops{
+                    [](void* p, Args&&... args) -> R {
+                        return call(**static_cast<Fn**>(p), std::forward<Args>(args)...);
+                    },
+                    [](void* dst, void* src) noexcept {
+                        ::new (dst) Fn*(*static_cast<Fn**>(src));
+                    },
+                    [](void* p) noexcept { delete *static_cast<Fn**>(p); },
+                    nullptr,
+                    false
+                };
+                return &ops;
+            }
+
+        private:
+            template<typename Fn>
+            static R call(Fn& f, Args&&... args) {
+                if constexpr (std::is_void<R>::value) {
+                    f(std::forward<Args>(args)...);
+                } else {
+                    return f(std::forward<Args>(args)...);
+                }
+            }
+
+            template<typename Fn>
+            static constexpr auto copier() noexcept -> void (*)(void*, const void*) {
+                if constexpr (std::is_copy_constructible<Fn>::value) {
+                    return [](void* dst, const void* src) { ::new (dst) Fn(*static_cast<const Fn*>(src)); };
+                } else {
+                    return nullptr;
+                }
+            }
+        };
+    }
+
+    // std::function must be copyable, so it can't hold a closure that owns a
+    // std::unique_ptr (see Item 32), or a std::packaged_task. UniqueFunction is
+    // move-only instead, and so accepts those too. Closures that fit in Capacity
+    // bytes, and won't throw when moved, are stored inline without allocating;
+    // bigger ones go on the heap, once, and moving a UniqueFunction never
+    // allocates. Calling an empty one throws std::bad_function_call, as
+    // std::function does. The call operator isn't const: the closure may
+    // change its own state when called, and a const UniqueFunction shouldn't.
+    template<typename Signature, std::size_t Capacity = 4 * sizeof(void*)>
+    class UniqueFunction;
+
+    template<typename R, typename... Args, std::size_t Capacity>
+    class UniqueFunction<R(Args...), Capacity> {
+    public:
+        UniqueFunction() noexcept = default;
+        UniqueFunction(std::nullptr_t) noexcept {}
+
+        template<typename F,
+                 typename = std::enable_if_t<!std::is_same<std::decay_t<F>, UniqueFunction>::value &&
+                                             std::is_invocable_r<R, std::decay_t<F>&, Args...>::value>>
+        UniqueFunction(F&& f) {
+            using Fn = std::decay_t<F>;
+            if constexpr (fitsInline<Fn>()) {
+                ::new (static_cast<void*>(storage)) Fn(std::forward<F>(f));
+                ops = Ops::template inlineOps<Fn>();
+            } else {
+                ::new (static_cast<void*>(storage)) Fn*(new Fn(std::forward<F>(f)));
+                ops = Ops::template heapOps<Fn>();
+            }
+        }
+
+        UniqueFunction(UniqueFunction&& rhs) noexcept : ops(rhs.ops) {
+            if (ops) ops->move(storage, rhs.storage);
+            rhs.ops = nullptr;
+        }
+
+        UniqueFunction& operator=(UniqueFunction&& rhs) noexcept {
+            if (this != &rhs) {
+                reset();
+                if (rhs.ops) rhs.ops->move(storage, rhs.storage);
+                ops = rhs.ops;
+                rhs.ops = nullptr;
+            }
+            return *this;
+        }
+
+        UniqueFunction& operator=(std::nullptr_t) noexcept {
+            reset();
+            return *this;
+        }
+
+        UniqueFunction(const UniqueFunction&) = delete;
+        UniqueFunction& operator=(const UniqueFunction&) = delete;
+
+        ~UniqueFunction() { reset(); }
+
+        explicit operator bool() const noexcept { return ops != nullptr; }
+
+        // true if the closure lives inside this object rather than on the heap
+        bool storedInline() const noexcept { return ops && ops->storedInline; }
+
+        R operator()(Args... args) {
+            if (!ops) throw std::bad_function_call();
+            return ops->invoke(storage, std::forward<Args>(args)...);
+        }
+
+    private:
+        using Ops = detail::FunctionOps<R, Args...>;
+
+        template<typename Fn>
+        static constexpr bool fitsInline() noexcept {
+            return sizeof(Fn) <= Capacity &&
+                   alignof(Fn) <= alignof(std::max_align_t) &&
+                   std::is_nothrow_move_constructible<Fn>::value;
+        }
+
+        void reset() noexcept {
+            if (ops) ops->destroy(storage);
+            ops = nullptr;
+        }
+
+        static_assert(Capacity >= sizeof(void*), "UniqueFunction needs room for at least a pointer");
+
+        alignas(std::max_align_t) unsigned char storage[Capacity];
+        const Ops* ops = nullptr;
+    };
+}
+
 namespace item35 {
     int doAsyncwork(int value) { return value; };
 }
@@ -105,7 +270,13 @@ namespace item37 {
 
 
     // returns whether computation was performed
-    bool doWork(std::function<bool(int)> filter, int maxVal = tenMillion) {
+    //
+    // filter is taken by universal reference rather than as a std::function:
+    // doWork calls it ten million times, and a call through std::function's
+    // type erasure can't be inlined, so even a predicate as simple as
+    // "value % divisor == 0" costs an indirect call per value.
+    template<typename Filter>
+    bool doWork(Filter&& filter, int maxVal = tenMillion) {
         std::vector<int> goodVals;      // values that satisfy filter
 
         ThreadRAII t(std::thread([&filter, maxVal, &goodVals] {
@@ -128,9 +299,155 @@ namespace item37 {
         return false;
     }
 
+    // the original interface, now just an adapter over the template
+    bool doWork(std::function<bool(int)> filter, int maxVal = tenMillion) {
+        return doWork<std::function<bool(int)>&>(filter, maxVal);
+    }
 
+    // and for filters that own what they capture, which std::function can't hold
+    bool doWork(item31::UniqueFunction<bool(int)> filter, int maxVal = tenMillion) {
+        return doWork<item31::UniqueFunction<bool(int)>&>(filter, maxVal);
+    }
+
+
+    // doWork scans the whole range on one thread. The parallel version splits
+    // 0..maxVal into chunks and deals them round-robin to numThreads workers
+    // (worker w gets chunks w, w + numThreads, ...). Each worker appends its
+    // matches to its own vector and remembers where each chunk's matches end,
+    // so the results can be stitched back together in chunk order, giving
+    // exactly the serial order, with a single allocation for the final vector.
+    struct ParallelOptions {
+        unsigned numThreads = std::thread::hardware_concurrency();
+        int chunkSize = 16 * 1024;          // values per chunk
+    };
+
+    std::vector<int> parallelFilter(const std::function<bool(int)>& filter,
+                                    int maxVal,
+                                    const ParallelOptions& opts = {}) {
+        if (maxVal < 0) return {};
+
+        const long long numVals = static_cast<long long>(maxVal) + 1;
+        const long long chunkSize = opts.chunkSize > 0 ? opts.chunkSize : ParallelOptions{}.chunkSize;
+        const long long numChunks = (numVals + chunkSize - 1) / chunkSize;
+        const unsigned numThreads = static_cast<unsigned>(
+            std::max(1LL, std::min<long long>(opts.numThreads, numChunks)));
+
+        struct PerThread {
+            std::vector<int> vals;
+            std::vector<std::size_t> chunkEnds;     // vals.size() after each chunk
+        };
+        std::vector<PerThread> results(numThreads);
+
+        {
+            std::vector<ThreadRAII> workers;
+            workers.reserve(numThreads);
+
+            for (unsigned w = 0; w < numThreads; ++w) {
+                workers.emplace_back(std::thread([&, w] {
+                    auto& mine = results[w];
+                    for (auto c = static_cast<long long>(w); c < numChunks; c += numThreads) {
+                        const auto first = static_cast<int>(c * chunkSize);
+                        const auto last = static_cast<int>(std::min(numVals, (c + 1) * chunkSize) - 1);
+                        for (auto i = first; ; ++i) {
+                            if (filter(i)) mine.vals.push_back(i);
+                            if (i == last) break;   // last may be INT_MAX
+                        }
+                        mine.chunkEnds.push_back(mine.vals.size());
+                    }
+                }), ThreadRAII::DtorAction::join);
+            }
+        }   // workers joined here, on every path
+
+        std::size_t total = 0;
+        for (auto& r : results) total += r.vals.size();
+
+        std::vector<int> goodVals;
+        goodVals.reserve(total);
+
+        for (long long c = 0; c < numChunks; ++c) {
+            auto& r = results[c % numThreads];
+            auto k = static_cast<std::size_t>(c / numThreads);
+            auto first = k == 0 ? 0 : r.chunkEnds[k - 1];
+            goodVals.insert(goodVals.end(),
+                            r.vals.begin() + first,
+                            r.vals.begin() + r.chunkEnds[k]);
+        }
+
+        return goodVals;
+    }
+
+    // returns whether computation was performed
+    bool doWorkParallel(std::function<bool(int)> filter,
+                        int maxVal = tenMillion,
+                        const ParallelOptions& opts = {}) {
+        auto goodVals = parallelFilter(filter, maxVal, opts);
+
+        // if(conditionsAreSatisfied()) {
+        if (true) {
+            // performComputation(goodVals);
+            return true;
+        }
+
+        return false;
+    }
+
+
+    // Compare the two doWork paths on item31-style divisor filters:
+    // the same lambda, once called directly and once through std::function.
+    template<typename F>
+    double timeMs(F&& f) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    void benchmarkFilterDispatch() {
+        for (auto divisor : { 3, 7, 1000 }) {
+            auto filter = [divisor](int value) { return value % divisor == 0; };
+            std::function<bool(int)> erased = filter;
+
+            auto direct = timeMs([&] { doWork(filter); });
+            auto viaFunction = timeMs([&] { doWork(erased); });
+
+            std::cout << "divisor " << divisor
+                      << ": template " << direct << " ms"
+                      << ", std::function " << viaFunction << " ms" << '\n';
+        }
+    }
 }
 
 int main() {
+    using namespace item37;
+
+    auto divisibleBy7 = [](int value) { return value % 7 == 0; };
+
+    doWork(divisibleBy7);
+    doWorkParallel(divisibleBy7);
+
+    item31::UniqueFunction<bool(int)> ownsDivisor =
+        [divisor = std::make_unique<int>(7)](int value) { return value % *divisor == 0; };
+    doWork(std::move(ownsDivisor));
+
+    // the parallel results must be exactly what doWork's serial loop finds:
+    // a dropped, duplicated or misplaced chunk shows up as a mismatch
+    std::vector<int> serialVals;
+    for (auto i = 0; i <= tenMillion; ++i) {
+        if (divisibleBy7(i)) serialVals.push_back(i);
+    }
+
+    auto matches = true;
+    for (auto opts : { ParallelOptions{}, ParallelOptions{ 8, 4096 }, ParallelOptions{ 3, 1000 },
+                       ParallelOptions{ 64, 1 << 20 }, ParallelOptions{ 1, 7 } }) {
+        auto goodVals = parallelFilter(divisibleBy7, tenMillion, opts);
+        std::cout << opts.numThreads << " threads, chunks of " << opts.chunkSize << ": "
+                  << goodVals.size() << " values, same as serial: " << std::boolalpha
+                  << (goodVals == serialVals) << '\n';
+        matches = matches && goodVals == serialVals;
+    }
+    if (!matches) return 1;
+
+    benchmarkFilterDispatch();
+
     return 0;
 }
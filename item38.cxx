@@ -2,6 +2,15 @@
 #include <future>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
 
 
 // ITEM 38: Be aware of varying thread handle destructor behavior.
@@ -132,7 +141,253 @@ namespace item38 {
     // via std::async
     std::vector<std::future<void>> futs;
 
+
+    // A TaskGroup avoids that: its futures come from std::promises, whose
+    // destructors never block, and the tasks run on threads the group doesn't
+    // join. Waiting is always explicit, and can be bounded by a deadline;
+    // destroying the group only asks its tasks to stop, through the
+    // CancellationToken each of them may take, and returns at once.
+    //
+    // A destroyed group's tasks may still be running, so whatever a task
+    // refers to must outlive it: capture by value, or wait for the task before
+    // the referent goes away. The group's own bookkeeping is shared with its
+    // tasks and lives as long as the last of them. Finishing a task only
+    // readies its future, and its thread may not have exited yet, so before
+    // the program ends something has to join the threads: cancelAndJoin for a
+    // group that's still around, and joinAbandoned for the threads of groups
+    // already destroyed, which the destructor hands over rather than detach
+    // (Item 37).
+    class CancellationToken {
+    public:
+        bool stopRequested() const noexcept {
+            return flag && flag->load(std::memory_order_acquire);
+        }
+
+    private:
+        friend class TaskGroup;
+        explicit CancellationToken(std::shared_ptr<const std::atomic<bool>> flag) noexcept
+            : flag(std::move(flag)) {}
+
+        std::shared_ptr<const std::atomic<bool>> flag;
+    };
+
+    class TaskGroup {
+    public:
+        TaskGroup() : state(std::make_shared<State>()) {}
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        ~TaskGroup() {                  // no join: the tasks hold on to state
+            cancel();
+            try {
+                auto& a = abandoned();
+                std::lock_guard<std::mutex> g(a.m);
+                a.threads.reserve(a.threads.size() + threads.size());
+                for (auto& t : threads) a.threads.push_back(std::move(t));
+            } catch (...) {             // nowhere to keep them: let them go
+                for (auto& t : threads) {
+                    if (t.joinable()) t.detach();
+                }
+            }
+        }
+
+        // run f on a thread of its own, passing it this group's token if it
+        // takes one; the result, or whatever f throws, arrives in the future
+        template<typename F>
+        auto spawn(F&& f) {
+            using Fn = std::decay_t<F>;
+            using R = typename Result<Fn, std::is_invocable<Fn&, CancellationToken>::value>::type;
+
+            std::promise<R> promise;
+            std::shared_future<R> result = promise.get_future().share();
+
+            std::size_t index;
+            {
+                std::lock_guard<std::mutex> g(state->m);
+                index = state->spawned++;
+            }
+
+            try {                       // if emplace_back throws, no thread started
+                threads.emplace_back([state = state, index, f = std::forward<F>(f), p = std::move(promise)]() mutable {
+                    try {
+                        if constexpr (std::is_void<R>::value) {
+                            invoke(f, state);
+                            p.set_value();
+                        } else {
+                            p.set_value(invoke(f, state));
+                        }
+                    } catch (...) {
+                        p.set_exception(std::current_exception());
+                    }
+                    state->finish(index);
+                });
+            } catch (...) {             // no thread: the future holds a broken_promise
+                state->finish(index);
+                throw;
+            }
+
+            return result;
+        }
+
+        void cancel() noexcept { state->cancelled.store(true, std::memory_order_release); }
+
+        // cancel, then wait for every task's thread to exit; not from one of
+        // the group's own tasks
+        void cancelAndJoin() {
+            cancel();
+            for (auto& t : threads) t.join();
+            threads.clear();
+        }
+
+        // wait for the threads of every group destroyed so far; their tasks
+        // have been asked to stop, but may not have yet. Call it before main
+        // returns, so that none of them outlives the program's statics.
+        static void joinAbandoned() {
+            std::vector<std::thread> ts;
+            {
+                auto& a = abandoned();
+                std::lock_guard<std::mutex> g(a.m);
+                ts.swap(a.threads);
+            }
+            for (auto& t : ts) t.join();
+        }
+
+        CancellationToken token() const noexcept {
+            return CancellationToken(std::shared_ptr<const std::atomic<bool>>(state, &state->cancelled));
+        }
+
+        std::size_t size() const {
+            std::lock_guard<std::mutex> g(state->m);
+            return state->spawned;
+        }
+
+        std::size_t pending() const {
+            std::lock_guard<std::mutex> g(state->m);
+            return state->spawned - state->finished.size();
+        }
+
+        void waitAll() {
+            std::unique_lock<std::mutex> g(state->m);
+            state->cv.wait(g, [this] { return allDone(); });
+        }
+
+        // true if every task finished by deadline
+        template<typename Clock, typename Duration>
+        bool waitAllUntil(const std::chrono::time_point<Clock, Duration>& deadline) {
+            std::unique_lock<std::mutex> g(state->m);
+            return state->cv.wait_until(g, deadline, [this] { return allDone(); });
+        }
+
+        template<typename Rep, typename Period>
+        bool waitAllFor(const std::chrono::duration<Rep, Period>& timeout) {
+            return waitAllUntil(std::chrono::steady_clock::now() + timeout);
+        }
+
+        // the index (in spawn order) of the next task to finish that no
+        // earlier waitAny reported, or nothing once every task has been
+        // reported
+        std::optional<std::size_t> waitAny() {
+            std::unique_lock<std::mutex> g(state->m);
+            state->cv.wait(g, [this] { return anyDone(); });
+            return takeFinished();
+        }
+
+        // as waitAny, but also nothing if no task finishes by deadline
+        template<typename Clock, typename Duration>
+        std::optional<std::size_t> waitAnyUntil(const std::chrono::time_point<Clock, Duration>& deadline) {
+            std::unique_lock<std::mutex> g(state->m);
+            state->cv.wait_until(g, deadline, [this] { return anyDone(); });
+            return takeFinished();
+        }
+
+        template<typename Rep, typename Period>
+        std::optional<std::size_t> waitAnyFor(const std::chrono::duration<Rep, Period>& timeout) {
+            return waitAnyUntil(std::chrono::steady_clock::now() + timeout);
+        }
+
+    private:
+        struct Abandoned {
+            std::mutex m;
+            std::vector<std::thread> threads;
+        };
+
+        static Abandoned& abandoned() {
+            static Abandoned* a = new Abandoned;    // never destroyed: a group may
+            return *a;                              // be destroyed during exit
+        }
+
+        struct State {
+            std::atomic<bool> cancelled{ false };
+
+            std::mutex m;
+            std::condition_variable cv;
+            std::size_t spawned = 0;
+            std::vector<std::size_t> finished;  // indices, in the order they finished
+            std::size_t reported = 0;           // how many of those waitAny returned
+
+            void finish(std::size_t index) {
+                {
+                    std::lock_guard<std::mutex> g(m);
+                    finished.push_back(index);
+                }
+                cv.notify_all();
+            }
+        };
+
+        template<typename Fn, bool TakesToken>
+        struct Result { using type = std::invoke_result_t<Fn&>; };
+
+        template<typename Fn>
+        struct Result<Fn, true> { using type = std::invoke_result_t<Fn&, CancellationToken>; };
+
+        template<typename Fn>
+        static decltype(auto) invoke(Fn& f, const std::shared_ptr<State>& s) {
+            if constexpr (std::is_invocable<Fn&, CancellationToken>::value) {
+                return f(CancellationToken(std::shared_ptr<const std::atomic<bool>>(s, &s->cancelled)));
+            } else {
+                return f();
+            }
+        }
+
+        // these three with state->m held
+        bool allDone() const { return state->finished.size() == state->spawned; }
+        bool anyDone() const { return state->finished.size() > state->reported || state->reported == state->spawned; }
+        std::optional<std::size_t> takeFinished() {
+            if (state->finished.size() == state->reported) return std::nullopt;
+            return state->finished[state->reported++];
+        }
+
+        std::shared_ptr<State> state;
+        std::vector<std::thread> threads;   // the owner's alone: tasks never touch it
+    };
+
+
     class Widget {
+    public:
+        Widget() = default;
+
+        // compute the value on group, from where the widget can be waited for,
+        // or abandoned, with everything else the group runs
+        explicit Widget(TaskGroup& group)
+            : fut(group.spawn([](CancellationToken token) {
+                  auto value = 0.0;
+                  for (auto i = 1; i <= 100 && !token.stopRequested(); ++i) {
+                      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                      value += 1.0 / i;
+                  }
+                  return value;
+              })) {}
+
+        bool ready() const {
+            return fut.valid() && fut.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+
+        double value() const {
+            if (!fut.valid()) throw std::future_error(std::future_errc::no_state);
+            return fut.get();
+        }
+
     private:
         std::shared_future<double> fut;
     };
@@ -140,5 +395,80 @@ namespace item38 {
 
 
 int main() {
+    using namespace item38;
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    // the std::async way: the vector's destructor waits for both tasks
+    auto start = Clock::now();
+    {
+        std::vector<std::future<void>> asyncFuts;
+        for (auto i = 0; i < 2; ++i) {
+            asyncFuts.push_back(std::async(std::launch::async,
+                                           [] { std::this_thread::sleep_for(std::chrono::milliseconds(50)); }));
+        }
+    }
+    std::cout << "std::async futures destroyed after " << ms(Clock::now() - start) << " ms" << '\n';
+
+    {
+        TaskGroup group;
+        Widget w(group);
+
+        for (auto i = 0; i < 4; ++i) {
+            group.spawn([i](CancellationToken token) {
+                for (auto n = 0; n < 20 * (i + 1) && !token.stopRequested(); ++n) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+        }
+        auto failing = group.spawn([] { throw std::runtime_error("failed"); });
+
+        auto first = group.waitAny();
+        std::cout << "task " << *first << " finished first" << '\n';
+
+        auto allDone = group.waitAllFor(std::chrono::milliseconds(200));
+        std::cout << "all done within 200 ms: " << std::boolalpha << allDone
+                  << ", widget value " << w.value() << '\n';
+        try {
+            failing.get();
+        } catch (const std::exception& e) {
+            std::cout << "the failing task threw: " << e.what() << '\n';
+        }
+
+        // more work, abandoned half way
+        for (auto i = 0; i < 8; ++i) {
+            group.spawn([](CancellationToken token) {
+                while (!token.stopRequested()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            });
+        }
+        Widget abandoned(group);
+        std::cout << group.pending() << " tasks pending" << '\n';
+        start = Clock::now();
+    }   // destroyed with all of them still running
+    std::cout << "task group destroyed after " << ms(Clock::now() - start) << " ms" << '\n';
+
+    // they're stopping now; make sure none of them outlives main
+    start = Clock::now();
+    TaskGroup::joinAbandoned();
+    std::cout << "abandoned tasks joined after " << ms(Clock::now() - start) << " ms" << '\n';
+
+    // a group still in scope can be stopped and joined in one go
+    {
+        TaskGroup group;
+        for (auto i = 0; i < 4; ++i) {
+            group.spawn([](CancellationToken token) {
+                while (!token.stopRequested()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            });
+        }
+        group.cancelAndJoin();
+        std::cout << group.pending() << " tasks pending after cancelAndJoin" << '\n';
+    }
+
+    try {
+        Widget{}.value();
+    } catch (const std::future_error& e) {
+        std::cout << "a default-constructed widget has no value: " << e.what() << '\n';
+    }
+
     return 0;
 }
@@ -3,6 +3,24 @@
 #include <random>
 #include <string>
 #include <memory>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <ostream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 
 // ITEM 39: Consider void futures for one-shot event communication.
@@ -146,9 +164,271 @@ namespace item38 {
     };
 }
 
+// Contention instrumentation for mutexes and atomics. Build with
+// -DITEM16_INSTRUMENT_LOCKS and every InstrumentedMutex counts its
+// acquisitions, how many of them found it already held, and keeps histograms
+// of how long threads waited for it and how long they held it; every
+// InstrumentedAtomic counts its read-modify-write operations, how many had to
+// retry because another thread got in first, and how long the retries took.
+// Objects with the same name share one set of numbers, which outlives them,
+// and dumpJson writes them all out.
+//
+// Without the flag, InstrumentedMutex is a std::mutex and InstrumentedAtomic a
+// std::atomic, with a name that's ignored; nothing is recorded, and dumpJson
+// just says so. Code that waits on a condition variable should use the
+// ConditionVariable and MutexLock aliases, which follow the mutex type.
+namespace contention {
+#ifdef ITEM16_INSTRUMENT_LOCKS
+    constexpr bool enabled = true;
+
+    // power-of-two buckets of nanoseconds: bucket b counts durations in
+    // [2^(b-1), 2^b), the last one everything longer
+    class Histogram {
+    public:
+        static constexpr std::size_t numBuckets = 40;      // up to ~9 minutes
+
+        void record(std::uint64_t ns) noexcept {
+            std::size_t b = 0;
+            while (b + 1 < numBuckets && (ns >> b) != 0) ++b;
+            buckets[b].fetch_add(1, std::memory_order_relaxed);
+            total.fetch_add(ns, std::memory_order_relaxed);
+            auto m = max.load(std::memory_order_relaxed);
+            while (ns > m && !max.compare_exchange_weak(m, ns, std::memory_order_relaxed)) {}
+        }
+
+        void writeJson(std::ostream& os) const {
+            std::uint64_t count = 0;
+            for (auto& b : buckets) count += b.load(std::memory_order_relaxed);
+
+            os << "{\"count\": " << count
+               << ", \"total_ns\": " << total.load(std::memory_order_relaxed)
+               << ", \"max_ns\": " << max.load(std::memory_order_relaxed)
+               << ", \"buckets\": [";
+            auto first = true;
+            for (std::size_t b = 0; b < numBuckets; ++b) {
+                auto n = buckets[b].load(std::memory_order_relaxed);
+                if (n == 0) continue;
+                os << (first ? "" : ", ") << "{\"below_ns\": ";
+                if (b + 1 < numBuckets) os << (std::uint64_t{ 1 } << b); else os << "null";
+                os << ", \"count\": " << n << '}';
+                first = false;
+            }
+            os << "]}";
+        }
+
+    private:
+        std::array<std::atomic<std::uint64_t>, numBuckets> buckets{};
+        std::atomic<std::uint64_t> total{ 0 };
+        std::atomic<std::uint64_t> max{ 0 };
+    };
+
+    struct Stats {
+        enum class Kind { mutex, atomic };
+
+        Stats(std::string name, Kind kind) : name(std::move(name)), kind(kind) {}
+
+        const std::string name;
+        const Kind kind;
+        std::atomic<std::uint64_t> acquisitions{ 0 };   // locks, or RMW operations
+        std::atomic<std::uint64_t> contended{ 0 };      // ... that had to wait, or retry
+        Histogram wait;
+        Histogram hold;                                 // mutexes only
+    };
+
+    class Registry {
+    public:
+        static Registry& instance() {
+            static Registry* r = new Registry;          // never destroyed, so it can
+            return *r;                                  // be used from static dtors
+        }
+
+        Stats& stats(const char* name, Stats::Kind kind) {
+            std::lock_guard<std::mutex> g(m);
+            for (auto& s : all) {
+                if (s->kind == kind && s->name == name) return *s;
+            }
+            all.push_back(std::make_unique<Stats>(name, kind));
+            return *all.back();
+        }
+
+        void writeJson(std::ostream& os) {
+            std::lock_guard<std::mutex> g(m);
+            os << "{\"enabled\": true, \"objects\": [";
+            for (std::size_t i = 0; i < all.size(); ++i) {
+                auto& s = *all[i];
+                os << (i ? ",\n  " : "\n  ") << "{\"name\": \"" << s.name << "\", \"kind\": \""
+                   << (s.kind == Stats::Kind::mutex ? "mutex" : "atomic") << "\""
+                   << ", \"acquisitions\": " << s.acquisitions.load(std::memory_order_relaxed)
+                   << ", \"contended\": " << s.contended.load(std::memory_order_relaxed)
+                   << ", \"wait\": ";
+                s.wait.writeJson(os);
+                if (s.kind == Stats::Kind::mutex) {
+                    os << ", \"hold\": ";
+                    s.hold.writeJson(os);
+                }
+                os << '}';
+            }
+            os << "\n]}\n";
+        }
+
+    private:
+        std::mutex m;
+        std::vector<std::unique_ptr<Stats>> all;
+    };
+
+    inline std::uint64_t nowNs() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    class InstrumentedMutex {
+    public:
+        explicit InstrumentedMutex(const char* name)
+            : stats(&Registry::instance().stats(name, Stats::Kind::mutex)) {}
+
+        InstrumentedMutex(const InstrumentedMutex&) = delete;
+        InstrumentedMutex& operator=(const InstrumentedMutex&) = delete;
+
+        void lock() {
+            if (!m.try_lock()) {
+                auto start = nowNs();
+                m.lock();
+                acquiredAt = nowNs();
+                stats->contended.fetch_add(1, std::memory_order_relaxed);
+                stats->wait.record(acquiredAt - start);
+            } else {
+                acquiredAt = nowNs();
+            }
+            stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        bool try_lock() {
+            if (!m.try_lock()) return false;
+            acquiredAt = nowNs();
+            stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        void unlock() {
+            stats->hold.record(nowNs() - acquiredAt);   // still ours to read
+            m.unlock();
+        }
+
+    private:
+        std::mutex m;
+        Stats* stats;
+        std::uint64_t acquiredAt = 0;                   // written by the owner only
+    };
+
+    using ConditionVariable = std::condition_variable_any;
+    using MutexLock = std::unique_lock<InstrumentedMutex>;
+
+    // Read-modify-write operations are compare-exchange loops, so a retry
+    // means another thread changed the value in between; only a retried
+    // operation reads the clock. Plain loads and stores aren't counted.
+    template<typename T>
+    class InstrumentedAtomic {
+    public:
+        explicit InstrumentedAtomic(const char* name, T desired = T())
+            : value(desired), stats(&Registry::instance().stats(name, Stats::Kind::atomic)) {}
+
+        InstrumentedAtomic(const InstrumentedAtomic&) = delete;
+        InstrumentedAtomic& operator=(const InstrumentedAtomic&) = delete;
+
+        T load(std::memory_order order = std::memory_order_seq_cst) const noexcept { return value.load(order); }
+        void store(T desired, std::memory_order order = std::memory_order_seq_cst) noexcept { value.store(desired, order); }
+        operator T() const noexcept { return load(); }
+        T operator=(T desired) noexcept { store(desired); return desired; }
+
+        T exchange(T desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return update([desired](T) { return desired; }, order);
+        }
+
+        bool compare_exchange_strong(T& expected, T desired,
+                                     std::memory_order order = std::memory_order_seq_cst) noexcept {
+            stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+            if (value.compare_exchange_strong(expected, desired, order)) return true;
+            stats->contended.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        bool compare_exchange_weak(T& expected, T desired,
+                                   std::memory_order order = std::memory_order_seq_cst) noexcept {
+            stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+            if (value.compare_exchange_weak(expected, desired, order)) return true;
+            stats->contended.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        T fetch_add(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return update([arg](T v) { return static_cast<T>(v + arg); }, order);
+        }
+        T fetch_sub(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return update([arg](T v) { return static_cast<T>(v - arg); }, order);
+        }
+        T fetch_and(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return update([arg](T v) { return static_cast<T>(v & arg); }, order);
+        }
+        T fetch_or(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return update([arg](T v) { return static_cast<T>(v | arg); }, order);
+        }
+        T fetch_xor(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return update([arg](T v) { return static_cast<T>(v ^ arg); }, order);
+        }
+
+        T operator++() noexcept { return static_cast<T>(fetch_add(1) + 1); }
+        T operator--() noexcept { return static_cast<T>(fetch_sub(1) - 1); }
+        T operator++(int) noexcept { return fetch_add(1); }
+        T operator--(int) noexcept { return fetch_sub(1); }
+        T operator+=(T arg) noexcept { return static_cast<T>(fetch_add(arg) + arg); }
+        T operator-=(T arg) noexcept { return static_cast<T>(fetch_sub(arg) - arg); }
+
+    private:
+        template<typename F>
+        T update(F f, std::memory_order order) noexcept {
+            stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+
+            auto old = value.load(std::memory_order_relaxed);
+            if (value.compare_exchange_strong(old, f(old), order, std::memory_order_relaxed)) return old;
+
+            auto start = nowNs();
+            while (!value.compare_exchange_weak(old, f(old), order, std::memory_order_relaxed)) {}
+            stats->contended.fetch_add(1, std::memory_order_relaxed);
+            stats->wait.record(nowNs() - start);
+            return old;
+        }
+
+        std::atomic<T> value;
+        Stats* stats;
+    };
+
+    inline void dumpJson(std::ostream& os) { Registry::instance().writeJson(os); }
+#else
+    constexpr bool enabled = false;
+
+    class InstrumentedMutex: public std::mutex {
+    public:
+        explicit InstrumentedMutex(const char*) noexcept {}
+    };
+
+    using ConditionVariable = std::condition_variable;
+    using MutexLock = std::unique_lock<std::mutex>;
+
+    template<typename T>
+    class InstrumentedAtomic: public std::atomic<T> {
+    public:
+        explicit InstrumentedAtomic(const char*, T desired = T()) noexcept : std::atomic<T>(desired) {}
+
+        using std::atomic<T>::operator=;
+    };
+
+    inline void dumpJson(std::ostream& os) { os << "{\"enabled\": false, \"objects\": []}\n"; }
+#endif
+}
+
 namespace item39 {
-    std::condition_variable cv;  // condvar for event
-    std::mutex m; // mutex for use with cv
+    contention::ConditionVariable cv;  // condvar for event
+    contention::InstrumentedMutex m{ "item39::m" }; // mutex for use with cv
 
     int i = 0;
 
@@ -160,7 +440,7 @@ namespace item39 {
     void detectTask() {
         // the code in the detecting is as simple as simple can be:
         // ...      detect event
-        std::unique_lock<std::mutex> lk(m);
+        contention::MutexLock lk(m);
         i = 1;
         cv.notify_one(); // tell reacting task
         std::cout << "detectTask finished." << "\n";
@@ -175,7 +455,7 @@ namespace item39 {
         // simply part of the C++11 API.
 
         // ... Prepare to react
-        std::unique_lock<std::mutex> lk(m);
+        contention::MutexLock lk(m);
         cv.wait(lk, []{ std::cout << "...finished waiting" << "\n";  return i == 1;});
         std::cout << "reactTask finished." << "\n";
     }
@@ -186,7 +466,7 @@ namespace item39 {
 
     void detectFlag() {
         {
-            std::lock_guard<std::mutex> g(m);
+            std::lock_guard<contention::InstrumentedMutex> g(m);
             std::this_thread::sleep_for(std::chrono::seconds(2));
             flag = true;
         }
@@ -197,7 +477,7 @@ namespace item39 {
         //while(!flag) {
         //    std::this_thread::sleep_for(std::chrono::seconds(1));
         //}
-        std::unique_lock<std::mutex> lk(m);
+        contention::MutexLock lk(m);
         cv.wait(lk, []{return flag; });
         std::cout << "flag has set to true" << "\n";
     }
@@ -260,6 +540,221 @@ namespace item39 {
             t.join();
         }
     }
+
+
+    // The promise above can be set only once, and its shared state lives on
+    // the heap; the condvar needs a mutex and a flag beside it. An event is
+    // just a 32-bit word: reacting tasks block on the word itself (a futex on
+    // Linux), so they take no mutex, and because the word remembers that it
+    // was set, a detecting task that gets there first can't leave them hung.
+    namespace detail {
+        using Word = std::atomic<std::uint32_t>;
+        static_assert(sizeof(Word) == sizeof(std::uint32_t) && Word::is_always_lock_free,
+                      "a futex is a plain 32-bit word");
+
+#if defined(__linux__)
+        // sleep while word == expected, for at most timeout (null: forever);
+        // may also return early, spuriously
+        inline void waitOnWord(Word& word, std::uint32_t expected, const timespec* timeout) noexcept {
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE,
+                    expected, timeout, nullptr, 0);
+        }
+
+        inline void wakeWord(Word& word, int count) noexcept {
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE,
+                    count, nullptr, nullptr, 0);
+        }
+#else
+        // no futex: poll, in short naps
+        inline void waitOnWord(Word& word, std::uint32_t expected, const timespec* timeout) noexcept {
+            auto nap = std::chrono::microseconds(50);
+            if (timeout) {
+                nap = std::min(nap, std::chrono::duration_cast<std::chrono::microseconds>(
+                                        std::chrono::seconds(timeout->tv_sec) +
+                                        std::chrono::nanoseconds(timeout->tv_nsec)));
+            }
+            if (word.load(std::memory_order_relaxed) == expected) std::this_thread::sleep_for(nap);
+        }
+
+        inline void wakeWord(Word&, int) noexcept {}
+#endif
+
+        // waits on word until done() or deadline, whichever comes first;
+        // returns done()
+        template<typename Done, typename Clock, typename Duration>
+        bool waitUntil(Word& word, std::uint32_t expected, Done done,
+                       const std::chrono::time_point<Clock, Duration>* deadline) {
+            if (!deadline) {
+                waitOnWord(word, expected, nullptr);
+                return done();
+            }
+
+            auto remaining = *deadline - Clock::now();
+            if (remaining <= remaining.zero()) return done();
+
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+            timespec timeout{};
+            timeout.tv_sec = static_cast<decltype(timeout.tv_sec)>(ns / 1'000'000'000);
+            timeout.tv_nsec = static_cast<decltype(timeout.tv_nsec)>(ns % 1'000'000'000);
+            waitOnWord(word, expected, &timeout);
+            return done();
+        }
+    }
+
+
+    // Stays set until reset, releasing every waiter, including any that only
+    // arrive after set. Waiters blocked when set is called are all released
+    // even if reset follows straight away: each set starts a new generation,
+    // and waiters watch for the generation to change, not just for the flag.
+    class ManualResetEvent {
+    public:
+        explicit ManualResetEvent(bool initiallySet = false) noexcept : state(initiallySet ? setBit : 0) {}
+
+        ManualResetEvent(const ManualResetEvent&) = delete;
+        ManualResetEvent& operator=(const ManualResetEvent&) = delete;
+
+        void set() noexcept {
+            auto s = state.load(std::memory_order_relaxed);
+            while (!(s & setBit) &&
+                   !state.compare_exchange_weak(s, (s + generationStep) | setBit,
+                                                std::memory_order_seq_cst, std::memory_order_relaxed)) {}
+            if (!(s & setBit) && waiters.load(std::memory_order_seq_cst) != 0) {
+                detail::wakeWord(state, std::numeric_limits<int>::max());
+            }
+        }
+
+        void reset() noexcept { state.fetch_and(~setBit, std::memory_order_relaxed); }
+
+        bool isSet() const noexcept { return state.load(std::memory_order_acquire) & setBit; }
+
+        void wait() noexcept { waitImpl<std::chrono::steady_clock::time_point>(nullptr); }
+
+        template<typename Clock, typename Duration>
+        bool waitUntil(const std::chrono::time_point<Clock, Duration>& deadline) {
+            return waitImpl(&deadline);
+        }
+
+        template<typename Rep, typename Period>
+        bool waitFor(const std::chrono::duration<Rep, Period>& timeout) {
+            return waitUntil(std::chrono::steady_clock::now() + timeout);
+        }
+
+    private:
+        static constexpr std::uint32_t setBit = 1;
+        static constexpr std::uint32_t generationStep = 2;     // the rest of the word
+
+        template<typename TimePoint>
+        bool waitImpl(const TimePoint* deadline) {
+            auto s = state.load(std::memory_order_acquire);
+            if (s & setBit) return true;
+
+            const auto generation = s & ~setBit;
+            auto released = [&] {
+                s = state.load(std::memory_order_acquire);
+                return (s & setBit) || (s & ~setBit) != generation;
+            };
+
+            // registering, then checking the word again, pairs with set's
+            // update then check of waiters: one of the two sees the other
+            waiters.fetch_add(1, std::memory_order_seq_cst);
+            auto done = released();
+            while (!done && !(deadline && Clock<TimePoint>::now() >= *deadline)) {
+                done = detail::waitUntil(state, s, released, deadline);
+            }
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+            return done;
+        }
+
+        template<typename TimePoint>
+        using Clock = typename TimePoint::clock;
+
+        detail::Word state;
+        std::atomic<std::uint32_t> waiters{ 0 };
+    };
+
+
+    // Releases one waiter per set, then resets itself; a set with nobody
+    // waiting is kept for the next wait. Setting an event that's already set
+    // does nothing, so sets that come faster than waits coalesce.
+    class Event {
+    public:
+        explicit Event(bool initiallySet = false) noexcept : state(initiallySet ? 1 : 0) {}
+
+        Event(const Event&) = delete;
+        Event& operator=(const Event&) = delete;
+
+        void set() noexcept {
+            if (state.exchange(1, std::memory_order_seq_cst) == 0 &&
+                waiters.load(std::memory_order_seq_cst) != 0) {
+                detail::wakeWord(state, 1);
+            }
+        }
+
+        void reset() noexcept { state.store(0, std::memory_order_relaxed); }
+
+        bool isSet() const noexcept { return state.load(std::memory_order_acquire) != 0; }
+
+        void wait() noexcept { waitImpl<std::chrono::steady_clock::time_point>(nullptr); }
+
+        template<typename Clock, typename Duration>
+        bool waitUntil(const std::chrono::time_point<Clock, Duration>& deadline) {
+            return waitImpl(&deadline);
+        }
+
+        template<typename Rep, typename Period>
+        bool waitFor(const std::chrono::duration<Rep, Period>& timeout) {
+            return waitUntil(std::chrono::steady_clock::now() + timeout);
+        }
+
+    private:
+        bool tryConsume() noexcept {
+            std::uint32_t expected = 1;
+            return state.compare_exchange_strong(expected, 0, std::memory_order_acquire,
+                                                 std::memory_order_relaxed);
+        }
+
+        template<typename TimePoint>
+        bool waitImpl(const TimePoint* deadline) {
+            if (tryConsume()) return true;
+
+            waiters.fetch_add(1, std::memory_order_seq_cst);    // as in ManualResetEvent
+            auto done = tryConsume();
+            while (!done && !(deadline && TimePoint::clock::now() >= *deadline)) {
+                done = detail::waitUntil(state, 0, [this] { return tryConsume(); }, deadline);
+            }
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+            return done;
+        }
+
+        detail::Word state;
+        std::atomic<std::uint32_t> waiters{ 0 };
+    };
+
+
+    // detectMuitiple again, with an event: nothing on the heap, and the same
+    // event works for every round
+    ManualResetEvent ready;
+
+    void detectEvent(int rounds) {
+        for (auto round = 0; round < rounds; ++round) {
+            std::atomic<int> reacted{ 0 };
+            std::vector<std::thread> vt;
+
+            for (int i = 0; i < 3; ++i) {
+                vt.emplace_back([&reacted] { ready.wait();
+                                             ++reacted; });
+            }
+
+            // ... // detect event
+            ready.set();
+            for (auto& t: vt) {
+                t.join();
+            }
+            ready.reset();  // ready for the next round
+
+            std::cout << "round " << round << ": " << reacted.load() << " reacted" << "\n";
+        }
+    }
 }
 
 
@@ -278,6 +773,30 @@ int main() {
     th3.join();
     th4.join();
 
+    // set before anyone waits: with a condvar, the reacting task would hang
+    ManualResetEvent early;
+    early.set();
+    std::thread(&ManualResetEvent::wait, &early).join();
+    std::cout << "waited on an event that was already set" << "\n";
+
+    detectEvent(3);
+
+    // ping-pong between two threads on a pair of auto-reset events
+    Event ping, pong;
+    constexpr auto rounds = 100'000;
+    auto start = std::chrono::steady_clock::now();
+    std::thread ponger([&] {
+        for (auto n = 0; n < rounds; ++n) { ping.wait(); pong.set(); }
+    });
+    for (auto n = 0; n < rounds; ++n) { ping.set(); pong.wait(); }
+    ponger.join();
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "round trip: " << elapsed.count() / rounds << " us" << "\n";
+
+    std::cout << std::boolalpha << "timed out: "
+              << !ping.waitFor(std::chrono::milliseconds(10)) << "\n";
+
+    contention::dumpJson(std::cout);
 
 
     return 0;
@@ -1,6 +1,19 @@
 #include <iostream>
 #include <future>
 #include <random>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 
 // ITEM 41: Consider pass by value for copyable parameters that are cheap
@@ -21,8 +34,332 @@
  *
  * */
 
+// Counting instrumentation for the items whose advice is about how many
+// allocations, copies and moves happen (17, 22, 41, 42). Every dynamic
+// allocation in the program goes through the replacement global operator new
+// and delete below, which count them; an AllocationScope reports what has
+// happened since it was created. CountingType counts calls of its own special
+// member functions the same way (a CountingScope reads them), and prints each
+// one while CountingType::log is set. expect() checks a count against the
+// number the item predicts; main's exit status is whether they all held.
+namespace accounting {
+    std::atomic<std::size_t> allocations{ 0 };
+    std::atomic<std::size_t> deallocations{ 0 };
+    std::atomic<std::size_t> bytesAllocated{ 0 };
+
+    struct AllocationCounts {
+        std::size_t allocations;
+        std::size_t deallocations;
+        std::size_t bytes;
+    };
+
+    AllocationCounts allocationTotals() noexcept {
+        return { allocations.load(std::memory_order_relaxed),
+                 deallocations.load(std::memory_order_relaxed),
+                 bytesAllocated.load(std::memory_order_relaxed) };
+    }
+
+    class AllocationScope {
+    public:
+        AllocationScope() noexcept : start(allocationTotals()) {}
+
+        AllocationCounts counts() const noexcept {
+            auto now = allocationTotals();
+            return { now.allocations - start.allocations,
+                     now.deallocations - start.deallocations,
+                     now.bytes - start.bytes };
+        }
+
+        std::size_t allocations() const noexcept { return counts().allocations; }
+        std::size_t deallocations() const noexcept { return counts().deallocations; }
+
+    private:
+        AllocationCounts start;
+    };
+
+    struct SpecialMemberCounts {
+        std::size_t constructs;         // from a value, or by default
+        std::size_t copyConstructs;
+        std::size_t moveConstructs;
+        std::size_t copyAssigns;
+        std::size_t moveAssigns;
+        std::size_t destructs;
+    };
+
+    // The counts are plain integers, so only one thread at a time should be
+    // using CountingTypes. The converting constructor is implicit so that a
+    // CountingType can stand in for an element type built from a different
+    // argument type (Item 42's std::string from a const char*).
+    class CountingType {
+    public:
+        CountingType() noexcept : CountingType(0) {}
+        CountingType(int value) noexcept : value(value) { note(counts.constructs, "constructed"); }
+
+        CountingType(const CountingType& rhs) noexcept : value(rhs.value) {
+            note(counts.copyConstructs, "copy constructed");
+        }
+        CountingType(CountingType&& rhs) noexcept : value(rhs.value) {
+            note(counts.moveConstructs, "move constructed");
+        }
+
+        CountingType& operator=(const CountingType& rhs) noexcept {
+            value = rhs.value;
+            note(counts.copyAssigns, "copy assigned");
+            return *this;
+        }
+        CountingType& operator=(CountingType&& rhs) noexcept {
+            value = rhs.value;
+            note(counts.moveAssigns, "move assigned");
+            return *this;
+        }
+
+        ~CountingType() { note(counts.destructs, "destroyed"); }
+
+        friend bool operator<(const CountingType& lhs, const CountingType& rhs) noexcept {
+            return lhs.value < rhs.value;
+        }
+
+        int value;
+
+        static SpecialMemberCounts counts;
+        static bool log;
+
+    private:
+        void note(std::size_t& count, const char* what) const noexcept {
+            ++count;
+            if (log) std::cout << "    CountingType(" << value << ") " << what << '\n';
+        }
+    };
+
+    SpecialMemberCounts CountingType::counts{};
+    bool CountingType::log = false;
+
+    class CountingScope {
+    public:
+        CountingScope() noexcept : start(CountingType::counts) {}
+
+        SpecialMemberCounts counts() const noexcept {
+            auto& now = CountingType::counts;
+            return { now.constructs - start.constructs,
+                     now.copyConstructs - start.copyConstructs,
+                     now.moveConstructs - start.moveConstructs,
+                     now.copyAssigns - start.copyAssigns,
+                     now.moveAssigns - start.moveAssigns,
+                     now.destructs - start.destructs };
+        }
+
+    private:
+        SpecialMemberCounts start;
+    };
+
+    int failureCount = 0;
+
+    bool expect(const char* what, std::size_t actual, std::size_t expected) {
+        const bool held = actual == expected;
+        if (!held) ++failureCount;
+
+        std::cout << (held ? "  ok    " : "  FAIL  ") << what << ": " << actual;
+        if (!held) std::cout << " (expected " << expected << ")";
+        std::cout << '\n';
+        return held;
+    }
+
+    int failures() noexcept { return failureCount; }
+}
+
+void* operator new(std::size_t size) {
+    accounting::allocations.fetch_add(1, std::memory_order_relaxed);
+    accounting::bytesAllocated.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+// GCC pairs the std::free here with the std::malloc in operator new only while
+// operator delete does nothing else, and otherwise flags every inlined
+// deallocation as mismatched
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+    if (p) accounting::deallocations.fetch_add(1, std::memory_order_relaxed);
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept { ::operator delete(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
 namespace item41 {
-    class Widget {
+    // A vector that keeps its first N elements inside the object itself and only
+    // goes to the heap once it outgrows them. For a Widget with a handful of
+    // names, that's no allocation for the container at all (and none per name,
+    // either, when the names fit std::string's small buffer).
+    template<typename T, std::size_t N>
+    class SmallVector {
+        static_assert(N > 0, "SmallVector needs room for at least one element inline");
+
+    public:
+        using value_type = T;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        SmallVector() noexcept = default;
+
+        SmallVector(const SmallVector& rhs) {
+            reserve(rhs.size());
+            for (auto& x : rhs) emplace_back(x);
+        }
+
+        SmallVector(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value) {
+            moveFrom(rhs);
+        }
+
+        SmallVector& operator=(const SmallVector& rhs) {
+            if (this != &rhs) {
+                clear();
+                reserve(rhs.size());
+                for (auto& x : rhs) emplace_back(x);
+            }
+            return *this;
+        }
+
+        SmallVector& operator=(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value) {
+            if (this != &rhs) {
+                clear();
+                releaseHeap();
+                moveFrom(rhs);
+            }
+            return *this;
+        }
+
+        ~SmallVector() {
+            clear();
+            releaseHeap();
+        }
+
+        template<typename... Ts>
+        T& emplace_back(Ts&&... params) {
+            if (count == cap) return growAndEmplace(std::forward<Ts>(params)...);
+            auto p = ::new (static_cast<void*>(ptr + count)) T(std::forward<Ts>(params)...);
+            ++count;
+            return *p;
+        }
+
+        void push_back(const T& x) { emplace_back(x); }
+        void push_back(T&& x) { emplace_back(std::move(x)); }
+
+        void reserve(std::size_t n) {
+            if (n > cap) grow(n);
+        }
+
+        void clear() noexcept {
+            for (std::size_t i = 0; i < count; ++i) ptr[i].~T();
+            count = 0;
+        }
+
+        std::size_t size() const noexcept { return count; }
+        std::size_t capacity() const noexcept { return cap; }
+        bool empty() const noexcept { return count == 0; }
+        bool isInline() const noexcept { return ptr == inlineData(); }
+
+        T& operator[](std::size_t i) noexcept { return ptr[i]; }
+        const T& operator[](std::size_t i) const noexcept { return ptr[i]; }
+
+        iterator begin() noexcept { return ptr; }
+        iterator end() noexcept { return ptr + count; }
+        const_iterator begin() const noexcept { return ptr; }
+        const_iterator end() const noexcept { return ptr + count; }
+
+    private:
+        T* inlineData() noexcept { return reinterpret_cast<T*>(buffer); }
+        const T* inlineData() const noexcept { return reinterpret_cast<const T*>(buffer); }
+
+        void grow(std::size_t newCap) {
+            auto p = std::allocator<T>().allocate(newCap);
+            try {
+                relocateTo(p, newCap);
+            } catch (...) {
+                std::allocator<T>().deallocate(p, newCap);
+                throw;
+            }
+        }
+
+        // params may refer to an element (v.push_back(v[0])), so the new
+        // element is built in the new buffer while the old ones are still
+        // alive, and they're moved over only after that
+        template<typename... Ts>
+        T& growAndEmplace(Ts&&... params) {
+            const auto newCap = cap * 2;
+            auto p = std::allocator<T>().allocate(newCap);
+            auto elem = p + count;
+            try {
+                ::new (static_cast<void*>(elem)) T(std::forward<Ts>(params)...);
+                try {
+                    relocateTo(p, newCap);
+                } catch (...) {
+                    elem->~T();
+                    throw;
+                }
+            } catch (...) {
+                std::allocator<T>().deallocate(p, newCap);
+                throw;
+            }
+            ++count;
+            return *elem;
+        }
+
+        // move the elements into p, which has room for newCap, and adopt it;
+        // if a move throws, *this is left as it was and p holds nothing
+        void relocateTo(T* p, std::size_t newCap) {
+            std::size_t i = 0;
+            try {
+                for (; i < count; ++i) ::new (static_cast<void*>(p + i)) T(std::move_if_noexcept(ptr[i]));
+            } catch (...) {
+                while (i != 0) p[--i].~T();
+                throw;
+            }
+
+            for (i = 0; i < count; ++i) ptr[i].~T();
+            releaseHeap();
+            ptr = p;
+            cap = newCap;
+        }
+
+        void releaseHeap() noexcept {
+            if (!isInline()) std::allocator<T>().deallocate(ptr, cap);
+            ptr = inlineData();
+            cap = N;
+        }
+
+        // *this is empty and inline
+        void moveFrom(SmallVector& rhs) noexcept(std::is_nothrow_move_constructible<T>::value) {
+            if (rhs.isInline()) {
+                for (std::size_t i = 0; i < rhs.count; ++i) {
+                    ::new (static_cast<void*>(ptr + i)) T(std::move(rhs.ptr[i]));
+                }
+                count = rhs.count;
+                rhs.clear();
+            } else {                        // steal the heap buffer
+                ptr = rhs.ptr;
+                cap = rhs.cap;
+                count = rhs.count;
+                rhs.ptr = rhs.inlineData();
+                rhs.cap = N;
+                rhs.count = 0;
+            }
+        }
+
+        alignas(T) unsigned char buffer[N * sizeof(T)];
+        T* ptr = inlineData();
+        std::size_t count = 0;
+        std::size_t cap = N;
+    };
+
+    // NameContainer lets a Widget keep its names in a std::vector (the default)
+    // or in a SmallVector with room for a few names inline
+    template<typename NameContainer>
+    class BasicWidget {
     public:
 //        void addName(const std::string& newName) { // take lvalue, copy it
 //            std::cout << "1" << "\n";
@@ -45,6 +382,8 @@ namespace item41 {
             names.push_back(std::move(newName));
         }
 
+        void reserveNames(std::size_t n) { names.reserve(n); }
+
         // std::unique_ptr is a move-only type, so the "overloading" approach
         // to its setter consists of a single function
         void setPtr(std::unique_ptr<std::string>&& ptr) {
@@ -52,10 +391,13 @@ namespace item41 {
         }
 
     private:
-        std::vector<std::string> names;
+        NameContainer names;
         std::unique_ptr<std::string> p;
     };
 
+    using Widget = BasicWidget<std::vector<std::string>>;
+    using SmallWidget = BasicWidget<SmallVector<std::string, 4>>;   // 4 names inline
+
 
     // assignment
     class Password {
@@ -72,10 +414,84 @@ namespace item41 {
             text = newPwd;                         // text.capacity() >= newPwd.size()
         }
 
+        // Always copies into text's existing buffer, so rotating between
+        // passwords that fit its capacity never allocates. The old password is
+        // zeroed first, in a way the optimiser can't treat as a dead store; if
+        // newPwd doesn't fit and text has to grow, the buffer being released
+        // has already been wiped.
+        void changeTo(std::string_view newPwd) {
+            // std::less and friends give a total order even for pointers into
+            // unrelated objects, where the builtin < and >= are unspecified
+            const char* first = text.data();
+            if (std::greater_equal<const char*>{}(newPwd.data(), first) &&
+                std::less<const char*>{}(newPwd.data(), first + text.size())) {
+                std::string copy(newPwd);          // newPwd views the old password
+                changeTo(std::string_view(copy));
+                secureWipe(copy);
+                return;
+            }
+
+            secureWipe(text);
+            text.assign(newPwd.data(), newPwd.size());
+        }
+
+        std::size_t capacity() const noexcept { return text.capacity(); }
+
     private:
+        // the empty asm claims to read the buffer, so the memset isn't dead
+        static void secureWipe(std::string& s) noexcept {
+#if defined(__GNUC__)
+            std::memset(s.data(), 0, s.size());
+            asm volatile("" : : "r"(s.data()) : "memory");
+#else
+            volatile char* p = s.data();
+            for (std::size_t i = 0; i < s.size(); ++i) p[i] = 0;
+#endif
+        }
+
         std::string text;   // text of password
     };
 
+    // Allocations and time per changeTo for the by-value and const& overloads
+    // and the string_view one, rotating between two passwords of each length.
+    // (changeTo(std::string) and changeTo(const std::string&) are ambiguous for
+    // a std::string argument, so the benchmark names the one it wants.)
+    template<typename Change>
+    void timeChangeTo(const char* label, std::size_t length, Change change) {
+        constexpr auto rounds = 100'000;
+        const std::string pwds[] = { std::string(length, 'a'), std::string(length, 'b') };
+
+        Password p(pwds[1]);
+        auto allocsBefore = accounting::allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+
+        for (auto i = 0; i < rounds; ++i) change(p, pwds[i & 1]);
+
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        auto allocs = accounting::allocations.load(std::memory_order_relaxed) - allocsBefore;
+
+        std::cout << "  " << label << ": " << elapsed.count() / rounds << " ns/op, "
+                  << static_cast<double>(allocs) / rounds << " allocs/op" << "\n";
+    }
+
+    void benchmarkChangeTo() {
+        using ByValue = void (Password::*)(std::string);
+        using ByConstRef = void (Password::*)(const std::string&);
+
+        for (std::size_t length : { 8, 15, 16, 32, 64, 256 }) {
+            std::cout << "password length " << length << "\n";
+            timeChangeTo("by value   ", length, [](Password& p, const std::string& s) {
+                (p.*static_cast<ByValue>(&Password::changeTo))(s);
+            });
+            timeChangeTo("const&     ", length, [](Password& p, const std::string& s) {
+                (p.*static_cast<ByConstRef>(&Password::changeTo))(s);
+            });
+            timeChangeTo("string_view", length, [](Password& p, const std::string& s) {
+                p.changeTo(std::string_view(s));
+            });
+        }
+    }
+
     // Slicing Problem
     class SpecialWdiget: public Widget{
     public:
@@ -86,6 +502,153 @@ namespace item41 {
                                     // including derived types
                                     // suffers from slicing problem
 
+
+
+    // The three addName designs from the top of Widget, timed with short names
+    // (which fit std::string's small buffer) and long ones, passed as lvalues
+    // and as rvalues. Each holder keeps its names in a reserved SmallVector so
+    // only the parameter passing differs.
+    struct NamesPassByValue {
+        void addName(std::string newName) { names.push_back(std::move(newName)); }
+        SmallVector<std::string, 4> names;
+    };
+
+    struct NamesOverloaded {
+        void addName(const std::string& newName) { names.push_back(newName); }
+        void addName(std::string&& newName) { names.push_back(std::move(newName)); }
+        SmallVector<std::string, 4> names;
+    };
+
+    struct NamesForwarded {
+        template<typename T>
+        void addName(T&& newName) { names.push_back(std::forward<T>(newName)); }
+        SmallVector<std::string, 4> names;
+    };
+
+    template<typename Holder, typename MakeArg>
+    double addNameNsPerOp(const std::string& name, MakeArg makeArg) {
+        constexpr auto rounds = 200'000;
+        std::size_t total = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (auto r = 0; r < rounds; ++r) {
+            Holder h;
+            for (auto i = 0; i < 4; ++i) h.addName(makeArg(name));
+            total += h.names.size();
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+        return elapsed.count() / static_cast<double>(total);
+    }
+
+    template<typename Holder>
+    void timeAddName(const char* label, const std::string& name) {
+        auto lvalue = [](const std::string& n) -> const std::string& { return n; };
+        auto rvalue = [](const std::string& n) { return std::string(n); };
+
+        std::cout << label << ": lvalue " << addNameNsPerOp<Holder>(name, lvalue)
+                  << " ns/op, rvalue " << addNameNsPerOp<Holder>(name, rvalue) << " ns/op" << "\n";
+    }
+
+    void benchmarkAddName() {
+        const std::string shortName("Bart");
+        const std::string longName("Bartholomew Jojo Simpson of Springfield");
+
+        for (auto name : { &shortName, &longName }) {
+            std::cout << (name == &shortName ? "short" : "long") << " name" << "\n";
+            timeAddName<NamesPassByValue>("  by value         ", *name);
+            timeAddName<NamesOverloaded>("  const& / && pair ", *name);
+            timeAddName<NamesForwarded>("  forwarding T&&   ", *name);
+        }
+    }
+
+    // Exact counts behind this item's claims. Names are CountingTypes, so the
+    // copies and moves of the parameter itself are visible: pass by value
+    // costs one move more than the overloads, for lvalues and rvalues alike.
+    // (The rvalue is a named object, cast with std::move; a temporary would
+    // be constructed straight into the by-value parameter.)
+    struct CountingPassByValue {
+        void addName(accounting::CountingType newName) { names.push_back(std::move(newName)); }
+        SmallVector<accounting::CountingType, 4> names;
+    };
+
+    struct CountingOverloaded {
+        void addName(const accounting::CountingType& newName) { names.push_back(newName); }
+        void addName(accounting::CountingType&& newName) { names.push_back(std::move(newName)); }
+        SmallVector<accounting::CountingType, 4> names;
+    };
+
+    struct CountingForwarded {
+        template<typename T>
+        void addName(T&& newName) { names.push_back(std::forward<T>(newName)); }
+        SmallVector<accounting::CountingType, 4> names;
+    };
+
+    template<typename Holder>
+    void checkAddName(const char* label, std::size_t extraMoves) {
+        using accounting::expect;
+        const accounting::CountingType name(1);
+        Holder h;
+
+        std::cout << label << '\n';
+        {
+            accounting::CountingScope scope;
+            h.addName(name);
+            expect("lvalue: copies", scope.counts().copyConstructs, 1);
+            expect("lvalue: moves", scope.counts().moveConstructs, extraMoves);
+        }
+        {
+            accounting::CountingType temp(2);
+            accounting::CountingScope scope;
+            h.addName(std::move(temp));
+            expect("rvalue: copies", scope.counts().copyConstructs, 0);
+            expect("rvalue: moves", scope.counts().moveConstructs, 1 + extraMoves);
+        }
+    }
+
+    // Assigning a password that fits text's capacity: by value, the copy is
+    // constructed, so it allocates (and text's old buffer is freed); by const&
+    // and by string_view, it's assigned into the buffer text already has.
+    void checkChangeTo() {
+        using accounting::expect;
+        using ByValue = void (Password::*)(std::string);
+        using ByConstRef = void (Password::*)(const std::string&);
+
+        const std::string next(64, 'b');
+        const std::string longer(128, 'c');
+        Password p(std::string(64, 'a'));
+
+        std::cout << "changeTo" << '\n';
+        {
+            accounting::AllocationScope scope;
+            (p.*static_cast<ByValue>(&Password::changeTo))(next);
+            expect("by value, fits: allocations", scope.allocations(), 1);
+            expect("by value, fits: deallocations", scope.deallocations(), 1);
+        }
+        {
+            accounting::AllocationScope scope;
+            (p.*static_cast<ByConstRef>(&Password::changeTo))(next);
+            expect("const&, fits: allocations", scope.allocations(), 0);
+        }
+        {
+            accounting::AllocationScope scope;
+            p.changeTo(std::string_view(next));
+            expect("string_view, fits: allocations", scope.allocations(), 0);
+        }
+        {
+            accounting::AllocationScope scope;
+            (p.*static_cast<ByConstRef>(&Password::changeTo))(longer);
+            expect("const&, doesn't fit: allocations", scope.allocations(), 1);
+            expect("const&, doesn't fit: deallocations", scope.deallocations(), 1);
+        }
+    }
+
+    void checkCounts() {
+        checkAddName<CountingPassByValue>("addName by value", 1);
+        checkAddName<CountingOverloaded>("addName const& / && pair", 0);
+        checkAddName<CountingForwarded>("addName forwarding T&&", 0);
+        checkChangeTo();
+    }
 }
 
 
@@ -103,11 +666,19 @@ int main() {
     w.addName(name + "Jenne");
 
 
+    SmallWidget sw4;            // names stay inside sw4
+    sw4.reserveNames(2);
+    sw4.addName(name);
+
+    checkCounts();
+    benchmarkAddName();
+    benchmarkChangeTo();
+
     SpecialWdiget sw;
 
     //processWdiget(sw); // processWidget sees a Widet, not a SpecialWidget!
 
 
 
-    return 0;
+    return accounting::failures() == 0 ? 0 : 1;
 }
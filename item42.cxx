@@ -3,6 +3,16 @@
 #include <regex>
 #include <memory>
 #include <list>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
 
 // ITEM 42: Consider emplacement instead of insertion
@@ -18,6 +28,162 @@
  *
  * */
 
+// Counting instrumentation for the items whose advice is about how many
+// allocations, copies and moves happen (17, 22, 41, 42). Every dynamic
+// allocation in the program goes through the replacement global operator new
+// and delete below, which count them; an AllocationScope reports what has
+// happened since it was created. CountingType counts calls of its own special
+// member functions the same way (a CountingScope reads them), and prints each
+// one while CountingType::log is set. expect() checks a count against the
+// number the item predicts; main's exit status is whether they all held.
+namespace accounting {
+    std::atomic<std::size_t> allocations{ 0 };
+    std::atomic<std::size_t> deallocations{ 0 };
+    std::atomic<std::size_t> bytesAllocated{ 0 };
+
+    struct AllocationCounts {
+        std::size_t allocations;
+        std::size_t deallocations;
+        std::size_t bytes;
+    };
+
+    AllocationCounts allocationTotals() noexcept {
+        return { allocations.load(std::memory_order_relaxed),
+                 deallocations.load(std::memory_order_relaxed),
+                 bytesAllocated.load(std::memory_order_relaxed) };
+    }
+
+    class AllocationScope {
+    public:
+        AllocationScope() noexcept : start(allocationTotals()) {}
+
+        AllocationCounts counts() const noexcept {
+            auto now = allocationTotals();
+            return { now.allocations - start.allocations,
+                     now.deallocations - start.deallocations,
+                     now.bytes - start.bytes };
+        }
+
+        std::size_t allocations() const noexcept { return counts().allocations; }
+        std::size_t deallocations() const noexcept { return counts().deallocations; }
+
+    private:
+        AllocationCounts start;
+    };
+
+    struct SpecialMemberCounts {
+        std::size_t constructs;         // from a value, or by default
+        std::size_t copyConstructs;
+        std::size_t moveConstructs;
+        std::size_t copyAssigns;
+        std::size_t moveAssigns;
+        std::size_t destructs;
+    };
+
+    // The counts are plain integers, so only one thread at a time should be
+    // using CountingTypes. The converting constructor is implicit so that a
+    // CountingType can stand in for an element type built from a different
+    // argument type (Item 42's std::string from a const char*).
+    class CountingType {
+    public:
+        CountingType() noexcept : CountingType(0) {}
+        CountingType(int value) noexcept : value(value) { note(counts.constructs, "constructed"); }
+
+        CountingType(const CountingType& rhs) noexcept : value(rhs.value) {
+            note(counts.copyConstructs, "copy constructed");
+        }
+        CountingType(CountingType&& rhs) noexcept : value(rhs.value) {
+            note(counts.moveConstructs, "move constructed");
+        }
+
+        CountingType& operator=(const CountingType& rhs) noexcept {
+            value = rhs.value;
+            note(counts.copyAssigns, "copy assigned");
+            return *this;
+        }
+        CountingType& operator=(CountingType&& rhs) noexcept {
+            value = rhs.value;
+            note(counts.moveAssigns, "move assigned");
+            return *this;
+        }
+
+        ~CountingType() { note(counts.destructs, "destroyed"); }
+
+        friend bool operator<(const CountingType& lhs, const CountingType& rhs) noexcept {
+            return lhs.value < rhs.value;
+        }
+
+        int value;
+
+        static SpecialMemberCounts counts;
+        static bool log;
+
+    private:
+        void note(std::size_t& count, const char* what) const noexcept {
+            ++count;
+            if (log) std::cout << "    CountingType(" << value << ") " << what << '\n';
+        }
+    };
+
+    SpecialMemberCounts CountingType::counts{};
+    bool CountingType::log = false;
+
+    class CountingScope {
+    public:
+        CountingScope() noexcept : start(CountingType::counts) {}
+
+        SpecialMemberCounts counts() const noexcept {
+            auto& now = CountingType::counts;
+            return { now.constructs - start.constructs,
+                     now.copyConstructs - start.copyConstructs,
+                     now.moveConstructs - start.moveConstructs,
+                     now.copyAssigns - start.copyAssigns,
+                     now.moveAssigns - start.moveAssigns,
+                     now.destructs - start.destructs };
+        }
+
+    private:
+        SpecialMemberCounts start;
+    };
+
+    int failureCount = 0;
+
+    bool expect(const char* what, std::size_t actual, std::size_t expected) {
+        const bool held = actual == expected;
+        if (!held) ++failureCount;
+
+        std::cout << (held ? "  ok    " : "  FAIL  ") << what << ": " << actual;
+        if (!held) std::cout << " (expected " << expected << ")";
+        std::cout << '\n';
+        return held;
+    }
+
+    int failures() noexcept { return failureCount; }
+}
+
+void* operator new(std::size_t size) {
+    accounting::allocations.fetch_add(1, std::memory_order_relaxed);
+    accounting::bytesAllocated.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+// GCC pairs the std::free here with the std::malloc in operator new only while
+// operator delete does nothing else, and otherwise flags every inlined
+// deallocation as mismatched
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+    if (p) accounting::deallocations.fetch_add(1, std::memory_order_relaxed);
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept { ::operator delete(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
 namespace item41 {
     class Widget {
     public:
@@ -96,11 +262,162 @@ namespace item42 {
         void push_back(T&& x);          // insert rvalue
     };
 
+    // Emplacement versus insertion, measured. Each pair below comes from this
+    // item and is run under the three conditions it lists: (1) the value is
+    // constructed into the container rather than assigned, (2) the argument
+    // type differs from the element type, (3) the container doesn't reject
+    // the value as a duplicate, plus node-based containers, where construction
+    // is always how a value gets in. Reported per operation: time, and the
+    // number of calls to the (counting) global operator new.
+    class Widget {};
+    void killWidget(Widget* pw) { delete pw; }
+
+    // long enough that a std::string of it doesn't fit the small-string buffer
+    constexpr const char* longText = "a string too long for the small buffer";
+
+    template<typename Container, typename Op>
+    void measure(const char* label, int ops, Op op) {
+        constexpr auto rounds = 20;
+        std::size_t allocs = 0;
+        double ns = 0;
+
+        for (auto r = 0; r < rounds; ++r) {
+            Container c;
+            auto allocsBefore = accounting::allocations.load(std::memory_order_relaxed);
+            auto start = std::chrono::steady_clock::now();
+
+            for (auto i = 0; i < ops; ++i) op(c, i);
+
+            ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            allocs += accounting::allocations.load(std::memory_order_relaxed) - allocsBefore;
+        }
+
+        const double total = static_cast<double>(rounds) * ops;
+        std::cout << "  " << std::left << std::setw(44) << label << std::right
+                  << std::setw(10) << std::fixed << std::setprecision(1) << ns / total << " ns/op"
+                  << std::setw(8) << std::setprecision(2) << allocs / total << " allocs/op" << '\n';
+    }
+
+    void benchmarkEmplacement() {
+        constexpr auto n = 10'000;
+        const std::string existing(longText);
+
+        std::cout << "(1)+(2) constructed at the end, const char* argument" << '\n';
+        measure<std::vector<std::string>>("vs.push_back(longText)", n,
+            [](auto& c, int) { c.push_back(longText); });
+        measure<std::vector<std::string>>("vs.emplace_back(longText)", n,
+            [](auto& c, int) { c.emplace_back(longText); });
+
+        std::cout << "(1) assigned: inserting at the front of a vector" << '\n';
+        measure<std::vector<std::string>>("vs.insert(vs.begin(), longText)", 1'000,
+            [](auto& c, int) { c.insert(c.begin(), longText); });
+        measure<std::vector<std::string>>("vs.emplace(vs.begin(), longText)", 1'000,
+            [](auto& c, int) { c.emplace(c.begin(), longText); });
+
+        std::cout << "(2) same type: the argument already is a std::string" << '\n';
+        measure<std::vector<std::string>>("vs.push_back(existing)", n,
+            [&](auto& c, int) { c.push_back(existing); });
+        measure<std::vector<std::string>>("vs.emplace_back(existing)", n,
+            [&](auto& c, int) { c.emplace_back(existing); });
+
+        std::cout << "node-based: ptrs, a std::list<std::shared_ptr<Widget>>" << '\n';
+        measure<std::list<std::shared_ptr<Widget>>>("ptrs.push_back({ new Widget, killWidget })", n,
+            [](auto& c, int) { c.push_back(std::shared_ptr<Widget>(new Widget, killWidget)); });
+        measure<std::list<std::shared_ptr<Widget>>>("ptrs.emplace_back(new Widget, killWidget)", n,
+            [](auto& c, int) { c.emplace_back(new Widget, killWidget); });
+        measure<std::list<std::string>>("std::list<std::string>::push_back", n,
+            [](auto& c, int) { c.push_back(longText); });
+        measure<std::list<std::string>>("std::list<std::string>::emplace_back", n,
+            [](auto& c, int) { c.emplace_back(longText); });
+
+        std::cout << "(3) duplicates rejected: every value is already present" << '\n';
+        measure<std::set<std::string>>("std::set::insert(existing)", n,
+            [&](auto& c, int) { c.insert(existing); });
+        measure<std::set<std::string>>("std::set::emplace(existing)", n,
+            [&](auto& c, int) { c.emplace(existing); });
+        measure<std::unordered_set<std::string>>("std::unordered_set::insert(existing)", n,
+            [&](auto& c, int) { c.insert(existing); });
+        measure<std::unordered_set<std::string>>("std::unordered_set::emplace(existing)", n,
+            [&](auto& c, int) { c.emplace(existing); });
+
+        std::cout << "regexes: construction dominates either way" << '\n';
+        measure<std::vector<std::regex>>("regexes.push_back(std::regex(\"[a-z]+\"))", 100,
+            [](auto& c, int) { c.push_back(std::regex("[a-z]+")); });
+        measure<std::vector<std::regex>>("regexes.emplace_back(\"[a-z]+\")", 100,
+            [](auto& c, int) { c.emplace_back("[a-z]+"); });
+    }
+
+    // Exact counts for the same conditions, with CountingType as the element
+    // type so each temporary shows up. Vectors are reserved first, so growth
+    // never adds moves of its own.
+    void checkCounts() {
+        using accounting::CountingType;
+        using accounting::CountingScope;
+        using accounting::AllocationScope;
+        using accounting::expect;
+
+        std::cout << "(2) different argument type: push_back builds and destroys a temporary" << '\n';
+        {
+            std::vector<CountingType> v;
+            v.reserve(4);
+            CountingScope pushed;
+            v.push_back(1);
+            auto p = pushed.counts();
+            expect("push_back(1): constructions", p.constructs, 1);
+            expect("push_back(1): moves", p.moveConstructs, 1);
+            expect("push_back(1): destructions", p.destructs, 1);
+
+            CountingScope emplaced;
+            v.emplace_back(1);
+            auto e = emplaced.counts();
+            expect("emplace_back(1): constructions", e.constructs, 1);
+            expect("emplace_back(1): moves", e.moveConstructs, 0);
+            expect("emplace_back(1): destructions", e.destructs, 0);
+        }
+
+        std::cout << "(2) same type: both copy the argument once" << '\n';
+        {
+            const CountingType existing(1);
+            std::vector<CountingType> v;
+            v.reserve(4);
+            CountingScope pushed;
+            v.push_back(existing);
+            expect("push_back(existing): copies", pushed.counts().copyConstructs, 1);
+            CountingScope emplaced;
+            v.emplace_back(existing);
+            expect("emplace_back(existing): copies", emplaced.counts().copyConstructs, 1);
+        }
+
+        std::cout << "(3) duplicate: emplace builds a node only to throw it away" << '\n';
+        {
+            const CountingType existing(1);
+            std::set<CountingType> s{ existing };
+            AllocationScope inserted;
+            s.insert(existing);
+            expect("set::insert(existing): allocations", inserted.allocations(), 0);
+            AllocationScope emplaced;
+            s.emplace(existing);
+            expect("set::emplace(existing): allocations", emplaced.allocations(), 1);
+            expect("set::emplace(existing): deallocations", emplaced.deallocations(), 1);
+        }
+
+        std::cout << "node-based: a std::list<std::shared_ptr<Widget>> with a custom deleter" << '\n';
+        {
+            std::list<std::shared_ptr<Widget>> ptrs;
+            AllocationScope pushed;
+            ptrs.push_back(std::shared_ptr<Widget>(new Widget, killWidget));
+            expect("push_back: allocations (Widget, control block, node)", pushed.allocations(), 3);
+            AllocationScope emplaced;
+            ptrs.emplace_back(new Widget, killWidget);
+            expect("emplace_back: allocations (same three)", emplaced.allocations(), 3);
+        }
+    }
+
 }
 
 
 
-int main() {
+int main(int argc, char* argv[]) {
     using namespace item42;
 
     // 1. A temporary std::string object is created from the string literal "xyzzy". This
@@ -135,6 +452,18 @@ int main() {
     // 2. The argument type(s) being passed differ from the type held by the container.
     // 3. The container is unlikely to reject the new value as a duplicate
 
+    // Report the counts before anything else runs: the regex demo below
+    // constructs a std::regex from nullptr, which crashes. "--check" stops here.
+    checkCounts();
+    std::cout << std::flush;
+    if (accounting::failures() != 0) {
+        std::cerr << accounting::failures() << " allocation count checks failed" << '\n';
+        return 1;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--check") return 0;
+
+    benchmarkEmplacement();
+
     class Widget{};
 
     std::list<std::shared_ptr<Widget>> ptrs;
@@ -165,5 +494,5 @@ int main() {
 
 
 
-    return 0;
+    return accounting::failures() == 0 ? 0 : 1;
 }
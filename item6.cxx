@@ -2,6 +2,10 @@
 #include <memory>   // include std::unique_ptr
 #include <functional>  // include std::function
 #include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
 
 
 using namespace std;
@@ -61,6 +65,158 @@ namespace item6 {
         };
     }
 
+    // std::vector<bool> packs its bools but hands them out through the proxy
+    // reference class above, one bit at a time. BitVector is explicit about
+    // being a bit set: operator[] returns a real bool (nothing to dangle), and
+    // the interesting operations work on whole 64-bit words, so combining or
+    // querying millions of flags runs at memory bandwidth.
+    //
+    // The word loops are written so the compiler can vectorize them; on x86-64
+    // ELF targets GCC and Clang also build a Haswell clone (AVX2 + POPCNT) of
+    // each, and pick one at load time from what the CPU supports.
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__ELF__)
+#define ITEM6_MULTIVERSION __attribute__((target_clones("arch=haswell", "default")))
+#else
+#define ITEM6_MULTIVERSION
+#endif
+
+    ITEM6_MULTIVERSION
+    inline void andWords(std::uint64_t* dst, const std::uint64_t* src, std::size_t n) noexcept {
+        for (std::size_t i = 0; i < n; ++i) dst[i] &= src[i];
+    }
+
+    ITEM6_MULTIVERSION
+    inline void orWords(std::uint64_t* dst, const std::uint64_t* src, std::size_t n) noexcept {
+        for (std::size_t i = 0; i < n; ++i) dst[i] |= src[i];
+    }
+
+    ITEM6_MULTIVERSION
+    inline void xorWords(std::uint64_t* dst, const std::uint64_t* src, std::size_t n) noexcept {
+        for (std::size_t i = 0; i < n; ++i) dst[i] ^= src[i];
+    }
+
+    ITEM6_MULTIVERSION
+    inline std::size_t popcountWords(const std::uint64_t* words, std::size_t n) noexcept {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < n; ++i) count += __builtin_popcountll(words[i]);
+        return count;
+    }
+
+    class BitVector {
+    public:
+        using word_type = std::uint64_t;
+        static constexpr std::size_t bitsPerWord = 64;
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        BitVector() = default;
+        explicit BitVector(std::size_t numBits, bool value = false)
+            : bits(numBits), words((numBits + bitsPerWord - 1) / bitsPerWord, value ? ~word_type{ 0 } : 0) {
+            clearPadding();
+        }
+        BitVector(std::initializer_list<bool> values) : BitVector(values.size()) {
+            std::size_t i = 0;
+            for (auto v : values) set(i++, v);
+        }
+
+        std::size_t size() const noexcept { return bits; }
+        std::size_t numWords() const noexcept { return words.size(); }
+
+        bool operator[](std::size_t i) const noexcept {     // a bool, not a proxy
+            return (words[i / bitsPerWord] >> (i % bitsPerWord)) & 1;
+        }
+
+        void set(std::size_t i, bool value = true) noexcept {
+            auto mask = word_type{ 1 } << (i % bitsPerWord);
+            auto& w = words[i / bitsPerWord];
+            w = value ? (w | mask) : (w & ~mask);
+        }
+
+        void reset(std::size_t i) noexcept { set(i, false); }
+
+        void push_back(bool value) {
+            if (bits % bitsPerWord == 0) words.push_back(0);
+            set(bits++, value);
+        }
+
+        // bits [64 * i, 64 * i + 64), bit 0 of the word is element 64 * i;
+        // bits past size() are always 0
+        word_type word(std::size_t i) const noexcept { return words[i]; }
+        const word_type* data() const noexcept { return words.data(); }
+
+        std::size_t count() const noexcept { return popcountWords(words.data(), words.size()); }
+        bool any() const noexcept { return findFirst() != npos; }
+        bool none() const noexcept { return !any(); }
+
+        // index of the first set bit at or after from, or npos
+        std::size_t findNext(std::size_t from) const noexcept {
+            if (from >= bits) return npos;
+
+            auto wi = from / bitsPerWord;
+            auto w = words[wi] & (~word_type{ 0 } << (from % bitsPerWord));
+            while (w == 0) {
+                if (++wi == words.size()) return npos;
+                w = words[wi];
+            }
+            return wi * bitsPerWord + static_cast<std::size_t>(__builtin_ctzll(w));
+        }
+
+        std::size_t findFirst() const noexcept { return findNext(0); }
+
+        // the whole-vector operations require equal sizes, and throw
+        // std::invalid_argument otherwise
+        BitVector& operator&=(const BitVector& rhs) {
+            requireSameSize(rhs);
+            andWords(words.data(), rhs.words.data(), words.size());
+            return *this;
+        }
+
+        BitVector& operator|=(const BitVector& rhs) {
+            requireSameSize(rhs);
+            orWords(words.data(), rhs.words.data(), words.size());
+            clearPadding();
+            return *this;
+        }
+
+        BitVector& operator^=(const BitVector& rhs) {
+            requireSameSize(rhs);
+            xorWords(words.data(), rhs.words.data(), words.size());
+            clearPadding();
+            return *this;
+        }
+
+        friend bool operator==(const BitVector& lhs, const BitVector& rhs) noexcept {
+            return lhs.bits == rhs.bits && lhs.words == rhs.words;
+        }
+        friend bool operator!=(const BitVector& lhs, const BitVector& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+    private:
+        void requireSameSize(const BitVector& rhs) const {
+            if (bits != rhs.bits) throw std::invalid_argument("BitVector sizes differ");
+        }
+
+        void clearPadding() noexcept {
+            if (bits % bitsPerWord != 0) {
+                words.back() &= (word_type{ 1 } << (bits % bitsPerWord)) - 1;
+            }
+        }
+
+        std::size_t bits = 0;
+        std::vector<word_type> words;
+    };
+
+    // lhs taken by value: the result is moved out of the caller's copy, so its
+    // buffer is reused. (Returning lhs op= rhs would copy the BitVector& that
+    // the compound assignment returns.)
+    inline BitVector operator&(BitVector lhs, const BitVector& rhs) { lhs &= rhs; return lhs; }
+    inline BitVector operator|(BitVector lhs, const BitVector& rhs) { lhs |= rhs; return lhs; }
+    inline BitVector operator^(BitVector lhs, const BitVector& rhs) { lhs ^= rhs; return lhs; }
+
+    BitVector featureBits(const Widget& ) {
+        return BitVector{true, false, true, false, true, true};
+    }
+
 
 }
 
@@ -95,5 +251,16 @@ int main() {
     // the explicitly typed initializer idiom
     auto highPriority_ = static_cast<bool>(features(w)[5]);
 
+    // BitVector has no proxy, so auto deduces bool
+    auto highPriority__ = featureBits(w)[5];
+    processWidget(w, highPriority__);
+
+    BitVector a(1'000'000), b(1'000'000);
+    for (std::size_t i = 0; i < a.size(); i += 3) a.set(i);
+    for (std::size_t i = 0; i < b.size(); i += 5) b.set(i);
+
+    auto both = a & b;
+    std::cout << both.count() << " flags in both, first past 0 at " << both.findNext(1) << "\n";
+
     return 0;
 }